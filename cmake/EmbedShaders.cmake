@@ -0,0 +1,39 @@
+# Writes every *.glsl file in SHADER_DIR into OUTPUT as the imsdl_shader_sources table.
+#
+# Usage: cmake -DSHADER_DIR=<dir> -DOUTPUT=<file.c> -P EmbedShaders.cmake
+
+file(GLOB shader_files RELATIVE "${SHADER_DIR}" "${SHADER_DIR}/*.glsl")
+list(SORT shader_files)
+
+set(arrays "")
+set(table "")
+set(index 0)
+foreach(name IN LISTS shader_files)
+    file(READ "${SHADER_DIR}/${name}" hex HEX)
+    string(LENGTH "${hex}" hex_length)
+    math(EXPR size "${hex_length} / 2")
+
+    # Sixteen bytes per line, followed by the terminator
+    set(bytes "")
+    set(offset 0)
+    while(offset LESS hex_length)
+        string(SUBSTRING "${hex}" ${offset} 32 line)
+        string(REGEX REPLACE "([0-9a-f][0-9a-f])" " 0x\\1," line "${line}")
+        string(APPEND bytes "   ${line}\n")
+        math(EXPR offset "${offset} + 32")
+    endwhile()
+    string(APPEND arrays "// ${name}\n")
+    string(APPEND arrays "static const unsigned char imsdl_shader_${index}[] = {\n${bytes}    0x00\n};\n\n")
+    string(APPEND table "    {\"${name}\", (const char*) imsdl_shader_${index}, ${size}},\n")
+    math(EXPR index "${index} + 1")
+endforeach()
+
+# The sentinel keeps the array non-empty when there are no shaders
+file(
+    WRITE "${OUTPUT}"
+    "/**\n * @file shader_sources.c\n * @brief Generated by EmbedShaders.cmake; do not edit.\n */\n\n"
+    "#include \"shaders.h\"\n\n"
+    "${arrays}"
+    "const IMSDL_ShaderSource imsdl_shader_sources[] = {\n${table}    {NULL, NULL, 0},\n};\n\n"
+    "const size_t imsdl_shader_source_count = ${index};\n"
+)
@@ -13,11 +13,15 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdalign.h>
+#include <stdbool.h>
 
 #ifdef _WIN32
     #include <malloc.h>
+    #include <windows.h>
 #else
     #include <errno.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
 #endif
 
 /**
@@ -39,7 +43,7 @@ void* aligned_pointer(void* ptr, size_t alignment);
  * @param size The size of the memory block to allocate.
  * @return A pointer to the aligned memory, or NULL if allocation fails.
  */
-void* aligned_malloc(size_t size, size_t alignment);
+void* aligned_malloc(size_t alignment, size_t size);
 
 /**
  * @brief Frees memory allocated with aligned_malloc.
@@ -51,4 +55,88 @@ void* aligned_malloc(size_t size, size_t alignment);
  */
 void aligned_free(void* ptr);
 
+// Size of a transparent huge page on x86-64 and most arm64 kernels
+#define ALIGN_HUGE_PAGE_SIZE ((size_t) 2 * 1024 * 1024)
+
+/**
+ * @brief Allocates a large block backed by huge pages where available.
+ *
+ * On Linux, the block is mapped aligned to ALIGN_HUGE_PAGE_SIZE and marked
+ * with madvise(MADV_HUGEPAGE). If transparent huge pages are disabled the
+ * kernel silently keeps regular pages, so the call still succeeds.
+ * On Windows, regular committed pages are used.
+ *
+ * @param size The size of the block, rounded up to ALIGN_HUGE_PAGE_SIZE.
+ * @param prefault Touch every page up front so the first frame does not fault.
+ * @return A pointer aligned to ALIGN_HUGE_PAGE_SIZE, or NULL if allocation fails.
+ */
+void* aligned_malloc_huge(size_t size, bool prefault);
+
+/**
+ * @brief Frees memory allocated with aligned_malloc_huge.
+ *
+ * @param ptr Pointer returned by aligned_malloc_huge.
+ * @param size The size that was passed to aligned_malloc_huge.
+ */
+void aligned_free_huge(void* ptr, size_t size);
+
+#ifdef IMSDL_MEMSTAT
+    #include "memstat.h"
+    // Attribute each allocation to its call site; size is evaluated twice
+    #define aligned_malloc(alignment, size) \
+        memstat_site(aligned_malloc((alignment), (size)), (size), __FILE__, __LINE__)
+#endif
+
+/**
+ * @brief Returns the system page size in bytes.
+ */
+size_t virtual_page_size(void);
+
+/**
+ * @brief Reserves a range of address space without committing memory.
+ *
+ * On POSIX systems, it maps the range with PROT_NONE and MAP_NORESERVE.
+ * On Windows, it uses VirtualAlloc with MEM_RESERVE.
+ *
+ * @param size The size of the range to reserve, rounded up to the page size.
+ * @return A page-aligned pointer to the range, or NULL if reservation fails.
+ */
+void* virtual_reserve(size_t size);
+
+/**
+ * @brief Commits pages within a reserved range so they can be read and written.
+ *
+ * @param ptr Page-aligned pointer into a range returned by virtual_reserve.
+ * @param size The number of bytes to commit, rounded up to the page size.
+ * @return True if the pages were committed, false otherwise.
+ */
+bool virtual_commit(void* ptr, size_t size);
+
+/**
+ * @brief Returns committed pages to the OS while keeping the range reserved.
+ *
+ * On POSIX the range is replaced by a new mapping, so earlier madvise hints
+ * such as virtual_advise_huge must be applied again.
+ *
+ * @param ptr Page-aligned pointer into a range returned by virtual_reserve.
+ * @param size The number of bytes to decommit, rounded up to the page size.
+ */
+void virtual_decommit(void* ptr, size_t size);
+
+/**
+ * @brief Releases a range returned by virtual_reserve.
+ *
+ * @param ptr Pointer returned by virtual_reserve.
+ * @param size The size that was passed to virtual_reserve.
+ */
+void virtual_release(void* ptr, size_t size);
+
+/**
+ * @brief Hints that a reserved range should be backed by huge pages.
+ *
+ * Pages committed later in the range become eligible for transparent huge
+ * pages. This is a no-op where the hint is unsupported.
+ */
+void virtual_advise_huge(void* ptr, size_t size);
+
 #endif // IMSDL_ALIGN_H
@@ -1,6 +1,15 @@
 /**
  * @file include/arena.h
  * @brief A simple linear allocator, also known as an Arena.
+ *
+ * The arena hands out memory by bumping an offset within a block. When a
+ * block runs out of space, a new block is chained after it. Blocks are never
+ * released until the arena is freed; resetting or restoring a mark simply
+ * rewinds the offset, so released blocks are reused by later pushes.
+ *
+ * A virtual arena instead reserves its whole capacity as address space up
+ * front and commits pages as the offset grows. It never chains blocks, so
+ * pointers stay stable and all of its memory is contiguous.
  */
 
 #ifndef IMSDL_ARENA_H
@@ -10,19 +19,245 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "memstat.h"
+
+// Granularity in bytes used when committing pages in a virtual arena
+#define ARENA_COMMIT_SIZE (64 * 1024)
+
+/**
+ * @brief Flags controlling how an arena obtains its memory.
+ *
+ * @param ARENA_FLAG_NONE Heap-backed blocks chained on demand.
+ * @param ARENA_FLAG_VIRTUAL Reserve address space once and commit pages on demand.
+ * @param ARENA_FLAG_DECOMMIT Return committed pages to the OS on reset (virtual only).
+ * @param ARENA_FLAG_HUGE_PAGES Back committed pages with huge pages (virtual only).
+ */
+typedef enum ArenaFlags {
+    ARENA_FLAG_NONE = 0,
+    ARENA_FLAG_VIRTUAL = 1 << 0,
+    ARENA_FLAG_DECOMMIT = 1 << 1,
+    ARENA_FLAG_HUGE_PAGES = 1 << 2
+} ArenaFlags;
+
+/**
+ * @struct ArenaBlock
+ * @brief A contiguous chunk of memory owned by an Arena.
+ */
+typedef struct ArenaBlock {
+    struct ArenaBlock* next; // Next block in the chain, or NULL
+    uint8_t* data; // Pointer to the aligned memory
+    size_t capacity; // Total capacity of the block in bytes
+    size_t committed; // Number of bytes backed by memory, equal to capacity for heap blocks
+    size_t offset; // Number of bytes currently used in the block
+} ArenaBlock;
+
 /**
  * @struct Arena
  * @brief A simple linear allocator, also known as an Arena.
  */
 typedef struct Arena {
-    void* data; // Pointer to the allocated memory
+    ArenaBlock* head; // First block in the chain
+    ArenaBlock* current; // Block currently being allocated from
     size_t element_size; // Size of each element in the arena
-    size_t alignment; // Alignment requirement for the arena's data
-    size_t capacity; // Total capacity of the arena in elements
-    size_t size; // Number of elements currently used in the arena
+    size_t alignment; // Default alignment requirement for the arena's data
+    size_t block_size; // Minimum capacity of chained blocks in bytes
+    unsigned flags; // Combination of ArenaFlags
+    MemStat stat; // Allocation statistics, only updated with IMSDL_MEMSTAT
 } Arena;
 
+/**
+ * @struct ArenaMark
+ * @brief A saved arena position used to release nested allocations.
+ */
+typedef struct ArenaMark {
+    ArenaBlock* block; // Block that was current when the mark was taken
+    size_t offset; // Offset within the block when the mark was taken
+} ArenaMark;
+
+/**
+ * @brief Creates an arena.
+ *
+ * @param initial_capacity The capacity of the first block in elements.
+ * @param element_size The size of each element in bytes.
+ * @param alignment The default alignment, must be a power of 2.
+ * @return A pointer to the arena, or NULL if allocation fails.
+ */
 Arena* arena_create(size_t initial_capacity, size_t element_size, size_t alignment);
+
+/**
+ * @brief Creates an arena backed by a single virtual memory reservation.
+ *
+ * Only address space is reserved up front; pages are committed in
+ * ARENA_COMMIT_SIZE steps as allocations reach them. Pushes beyond the
+ * reserved capacity fail instead of chaining a new block.
+ *
+ * @param max_capacity The reserved capacity in elements.
+ * @param element_size The size of each element in bytes.
+ * @param alignment The default alignment, must be a power of 2.
+ * @param flags ARENA_FLAG_DECOMMIT to release committed pages on reset, and
+ * ARENA_FLAG_HUGE_PAGES for large arenas that are walked linearly every frame.
+ * @return A pointer to the arena, or NULL if reservation fails.
+ */
+Arena* arena_create_virtual(
+    size_t max_capacity, size_t element_size, size_t alignment, unsigned flags
+);
+
+/**
+ * @brief Frees an arena and every block it owns.
+ */
 void arena_free(Arena* arena);
 
+/**
+ * @brief Pushes size bytes onto the arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param size The number of bytes to allocate.
+ * @param alignment The alignment of the returned pointer, or 0 for the arena's default.
+ * @return A pointer to uninitialized memory, or NULL if allocation fails.
+ */
+void* arena_push(Arena* arena, size_t size, size_t alignment);
+
+/**
+ * @brief Pushes size zero-initialized bytes onto the arena.
+ */
+void* arena_push_zero(Arena* arena, size_t size, size_t alignment);
+
+/**
+ * @brief Pushes count elements of the arena's element size.
+ *
+ * @return A pointer to uninitialized memory, or NULL on overflow or failure.
+ */
+void* arena_push_array(Arena* arena, size_t count);
+
+/**
+ * @brief Saves the current arena position.
+ */
+ArenaMark arena_mark(const Arena* arena);
+
+/**
+ * @brief Releases every allocation made since the mark was taken.
+ *
+ * @note Marks must be restored in LIFO order.
+ */
+void arena_restore(Arena* arena, ArenaMark mark);
+
+/**
+ * @brief Releases every allocation in O(1), keeping blocks for reuse.
+ *
+ * Virtual arenas created with ARENA_FLAG_DECOMMIT also return all but the
+ * first committed step to the OS.
+ */
+void arena_reset(Arena* arena);
+
+/**
+ * @brief Returns the number of bytes in use across all blocks.
+ */
+size_t arena_used(const Arena* arena);
+
+#ifdef IMSDL_MEMSTAT
+    // Attribute each push to its call site; size is evaluated twice
+    #define arena_push(arena, size, alignment) \
+        memstat_site(arena_push((arena), (size), (alignment)), (size), __FILE__, __LINE__)
+    #define arena_push_zero(arena, size, alignment) \
+        memstat_site(arena_push_zero((arena), (size), (alignment)), (size), __FILE__, __LINE__)
+    #define arena_push_array(arena, count) \
+        memstat_site( \
+            arena_push_array((arena), (count)), \
+            (count) * (arena)->element_size, \
+            __FILE__, \
+            __LINE__ \
+        )
+#endif
+
+/**
+ * @struct FrameArena
+ * @brief A pair of arenas that alternate every frame.
+ *
+ * Memory pushed during frame N stays valid while frame N+1 is built and is
+ * released in O(1) when frame N+2 begins.
+ */
+typedef struct FrameArena {
+    Arena* arenas[2]; // Arenas alternated between even and odd frames
+    uint64_t frame; // Number of completed frames
+} FrameArena;
+
+/**
+ * @brief Creates a frame arena.
+ *
+ * @param capacity The initial capacity of each arena in bytes.
+ * @param alignment The default alignment, must be a power of 2.
+ * @return A pointer to the frame arena, or NULL if allocation fails.
+ */
+FrameArena* frame_arena_create(size_t capacity, size_t alignment);
+
+/**
+ * @brief Frees a frame arena and both of its arenas.
+ */
+void frame_arena_free(FrameArena* frame_arena);
+
+/**
+ * @brief Returns the arena for the frame currently being built.
+ */
+Arena* frame_arena_current(FrameArena* frame_arena);
+
+/**
+ * @brief Returns the arena holding the previous frame's data.
+ */
+Arena* frame_arena_previous(FrameArena* frame_arena);
+
+/**
+ * @brief Ends the current frame and resets the arena for the next one.
+ */
+void frame_arena_swap(FrameArena* frame_arena);
+
+// Number of scratch arenas per thread, enough for one level of nesting
+#define ARENA_SCRATCH_COUNT 2
+
+// Address space reserved by each scratch arena in bytes
+#define ARENA_SCRATCH_SIZE ((size_t) 64 * 1024 * 1024)
+
+/**
+ * @struct ArenaScratch
+ * @brief A temporary scope on one of the calling thread's scratch arenas.
+ */
+typedef struct ArenaScratch {
+    Arena* arena; // Scratch arena to push onto, or NULL if creation failed
+    ArenaMark mark; // Position restored by arena_scratch_end
+} ArenaScratch;
+
+/**
+ * @brief Begins a scratch scope on the calling thread.
+ *
+ * Scratch arenas are virtual arenas created lazily per thread, so no lock
+ * or malloc is involved after first use. The returned arena is never one
+ * of the conflicts, which lets a function take scratch memory while its
+ * caller's scratch arena is passed in as the output arena.
+ *
+ * @param conflicts Arenas that must not be returned, may be NULL.
+ * @param conflict_count The number of arenas in conflicts.
+ * @return The scratch scope; its arena is NULL if none is available.
+ *
+ * Example usage:
+ * @code{.c}
+ * ArenaScratch scratch = arena_scratch_begin(&out, 1);
+ * char* buffer = arena_push(scratch.arena, 4096, 0);
+ * // ... build the result into out ...
+ * arena_scratch_end(scratch);
+ * @endcode
+ */
+ArenaScratch arena_scratch_begin(Arena* const* conflicts, size_t conflict_count);
+
+/**
+ * @brief Ends a scratch scope, releasing everything pushed since it began.
+ */
+void arena_scratch_end(ArenaScratch scratch);
+
+/**
+ * @brief Frees the calling thread's scratch arenas.
+ *
+ * Worker threads release them automatically on exit; the main thread may
+ * call this before returning from main.
+ */
+void arena_scratch_release(void);
+
 #endif // IMSDL_ARENA_H
@@ -0,0 +1,94 @@
+/**
+ * @file include/capture.h
+ * @brief Asynchronous framebuffer readback.
+ *
+ * glReadPixels into client memory stalls until every queued draw finishes.
+ * Reading into a pixel pack buffer instead returns immediately; a fence marks
+ * when the copy is done, and the pixels are mapped a frame or two later
+ * without waiting. Captures are kept in a small ring of pack buffers, so
+ * several frames can be in flight while earlier ones are read.
+ */
+
+#ifndef IMSDL_CAPTURE_H
+#define IMSDL_CAPTURE_H
+
+#include <GL/glew.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Number of captures that may be pending at once
+#define IMSDL_CAPTURE_BUFFERS 3
+
+/**
+ * @struct IMSDL_CaptureSlot
+ * @brief One pack buffer and the frame queued into it.
+ */
+typedef struct IMSDL_CaptureSlot {
+    GLuint buffer; // Pixel pack buffer, allocated on first use
+    size_t capacity; // Size of the buffer storage in bytes
+    GLsync fence; // Signaled once the pixels are in the buffer, or NULL if empty
+    int width; // Captured width in pixels
+    int height; // Captured height in pixels
+} IMSDL_CaptureSlot;
+
+/**
+ * @struct IMSDL_Capture
+ * @brief A FIFO of pending framebuffer captures.
+ */
+typedef struct IMSDL_Capture {
+    IMSDL_CaptureSlot slots[IMSDL_CAPTURE_BUFFERS];
+    uint32_t head; // Oldest pending capture
+    uint32_t count; // Number of pending captures
+} IMSDL_Capture;
+
+/**
+ * @brief Creates an empty capture queue.
+ *
+ * Requires a current GL context. Buffers are allocated on first use.
+ *
+ * @return A pointer to the queue, or NULL on allocation failure.
+ */
+IMSDL_Capture* imsdl_capture_create(void);
+
+/**
+ * @brief Waits for pending captures and frees the buffers.
+ */
+void imsdl_capture_free(IMSDL_Capture* capture);
+
+/**
+ * @brief Queues a readback of the bound read framebuffer.
+ *
+ * Call after the frame is drawn and before it is swapped.
+ *
+ * @return False if all buffers are pending or the buffer cannot be grown.
+ */
+bool imsdl_capture_queue(IMSDL_Capture* capture, int width, int height);
+
+/**
+ * @brief Copies the oldest pending capture into memory as RGBA8 rows.
+ *
+ * Rows are written top to bottom, flipped from GL's bottom-up order.
+ *
+ * @param pixels Receives width * height * 4 bytes.
+ * @param size The size of pixels in bytes.
+ * @param width Receives the captured width.
+ * @param height Receives the captured height.
+ * @param wait Block until the capture completes instead of returning false.
+ * @return False if no capture is ready or pixels is too small.
+ */
+bool imsdl_capture_read(
+    IMSDL_Capture* capture, uint8_t* pixels, size_t size, int* width, int* height, bool wait
+);
+
+/**
+ * @brief Writes RGBA8 rows, top to bottom, as a binary PPM image.
+ *
+ * Alpha is dropped.
+ *
+ * @return False if the file cannot be written.
+ */
+bool imsdl_capture_write_ppm(const char* path, const uint8_t* pixels, int width, int height);
+
+#endif // IMSDL_CAPTURE_H
@@ -0,0 +1,228 @@
+/**
+ * @file include/draw.h
+ * @brief Immediate-mode draw list.
+ *
+ * UI code appends primitives every frame. Boxes are recorded as rect
+ * instances, drawn as one shared unit quad and shaded with a signed
+ * distance function for rounded corners and borders. Other primitives are
+ * expanded into vertices and indices in one shared buffer. Draw commands
+ * record which range of instances or indices to draw, in submission order.
+ * Consecutive primitives of the same kind and texture extend the last
+ * command, so a frame of boxes is a single draw call.
+ *
+ * Vertices, indices, rects and commands live in virtual arenas, so each
+ * stays contiguous and can be uploaded with one copy. The list itself does
+ * not call OpenGL; the viewport submits it.
+ */
+
+#ifndef IMSDL_DRAW_H
+#define IMSDL_DRAW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+
+// Default number of vertices reserved by a draw list
+#define IMSDL_DRAW_MAX_VERTICES (1024 * 1024)
+
+// Pack 8-bit channels into a vertex color, laid out as R, G, B, A bytes in memory
+#define IMSDL_RGBA(r, g, b, a) \
+    ((uint32_t) (r) | ((uint32_t) (g) << 8) | ((uint32_t) (b) << 16) | ((uint32_t) (a) << 24))
+
+// Texture name that resolves to a 1x1 white texture, used by untextured primitives
+#define IMSDL_TEXTURE_NONE 0
+
+/**
+ * @struct IMSDL_Vec2
+ * @brief A 2D point or size in pixels.
+ */
+typedef struct IMSDL_Vec2 {
+    float x, y;
+} IMSDL_Vec2;
+
+/**
+ * @struct IMSDL_Vertex
+ * @brief A vertex in window coordinates with a top-left origin.
+ */
+typedef struct IMSDL_Vertex {
+    float x, y; // Position in pixels
+    float u, v; // Texture coordinates
+    uint32_t color; // Packed with IMSDL_RGBA
+} IMSDL_Vertex;
+
+// Index type submitted as GL_UNSIGNED_INT
+typedef uint32_t IMSDL_Index;
+
+/**
+ * @struct IMSDL_RectInstance
+ * @brief A rounded rectangle with an optional border, drawn by instancing.
+ */
+typedef struct IMSDL_RectInstance {
+    float x0, y0, x1, y1; // Bounds in pixels
+    float radius; // Corner radius in pixels, clamped to half the smaller side
+    float border; // Border width in pixels, drawn inside the bounds
+    uint32_t fill; // Fill color packed with IMSDL_RGBA
+    uint32_t border_color; // Border color packed with IMSDL_RGBA
+} IMSDL_RectInstance;
+
+/**
+ * @brief What a draw command reads.
+ *
+ * @param IMSDL_DRAW_TRIANGLES Indexed triangles from the vertex and index arrays.
+ * @param IMSDL_DRAW_RECTS Instances from the rect array.
+ */
+typedef enum IMSDL_DrawKind {
+    IMSDL_DRAW_TRIANGLES,
+    IMSDL_DRAW_RECTS
+} IMSDL_DrawKind;
+
+/**
+ * @struct IMSDL_DrawCommand
+ * @brief A range of indices or rect instances drawn in one call.
+ */
+typedef struct IMSDL_DrawCommand {
+    uint32_t kind; // IMSDL_DrawKind
+    uint32_t texture; // GL texture name, or IMSDL_TEXTURE_NONE; unused by rects
+    uint32_t offset; // First index or rect instance of the range
+    uint32_t count; // Number of indices or rect instances in the range
+} IMSDL_DrawCommand;
+
+/**
+ * @struct IMSDL_DrawList
+ * @brief Geometry and commands recorded for one frame.
+ */
+typedef struct IMSDL_DrawList {
+    Arena* vertices; // Contiguous IMSDL_Vertex array
+    Arena* indices; // Contiguous IMSDL_Index array
+    Arena* rects; // Contiguous IMSDL_RectInstance array
+    Arena* commands; // Contiguous IMSDL_DrawCommand array
+    uint32_t vertex_count; // Number of vertices recorded this frame
+    uint32_t index_count; // Number of indices recorded this frame
+    uint32_t rect_count; // Number of rect instances recorded this frame
+    uint32_t command_count; // Number of commands recorded this frame
+    uint32_t max_vertices; // Number of vertices reserved
+    uint32_t max_indices; // Number of indices reserved
+    uint32_t max_rects; // Number of rect instances reserved
+    uint32_t max_commands; // Number of commands reserved
+} IMSDL_DrawList;
+
+/**
+ * @brief Creates a draw list.
+ *
+ * @param max_vertices The number of vertices reserved, or 0 for
+ * IMSDL_DRAW_MAX_VERTICES. A quarter as many rect instances are reserved.
+ * Only the pages that are used get committed.
+ * @return A pointer to the draw list, or NULL if reservation fails.
+ */
+IMSDL_DrawList* imsdl_draw_list_create(size_t max_vertices);
+
+/**
+ * @brief Frees a draw list and its arenas.
+ */
+void imsdl_draw_list_free(IMSDL_DrawList* list);
+
+/**
+ * @brief Clears the draw list for the next frame in O(1).
+ */
+void imsdl_draw_list_reset(IMSDL_DrawList* list);
+
+/**
+ * @brief Returns the recorded vertices, indices, rect instances and commands.
+ */
+const IMSDL_Vertex* imsdl_draw_list_vertices(const IMSDL_DrawList* list);
+const IMSDL_Index* imsdl_draw_list_indices(const IMSDL_DrawList* list);
+const IMSDL_RectInstance* imsdl_draw_list_rects(const IMSDL_DrawList* list);
+const IMSDL_DrawCommand* imsdl_draw_list_commands(const IMSDL_DrawList* list);
+
+/**
+ * @brief Reserves room for one primitive and merges it into the last command.
+ *
+ * Indices written by the caller address the whole list, so they must be
+ * offset by the returned base vertex.
+ *
+ * @param list The draw list to append to.
+ * @param texture The texture the primitive samples.
+ * @param vertex_count The number of vertices to reserve.
+ * @param index_count The number of indices to reserve.
+ * @param vertices Receives the reserved vertices.
+ * @param indices Receives the reserved indices.
+ * @return The base vertex of the primitive, or UINT32_MAX if the list is full.
+ */
+uint32_t imsdl_draw_reserve(
+    IMSDL_DrawList* list,
+    uint32_t texture,
+    uint32_t vertex_count,
+    uint32_t index_count,
+    IMSDL_Vertex** vertices,
+    IMSDL_Index** indices
+);
+
+/**
+ * @brief Appends a rounded rectangle instance.
+ *
+ * @param min Top-left corner in pixels.
+ * @param max Bottom-right corner in pixels.
+ * @param radius Corner radius in pixels, 0 for square corners.
+ * @param fill Fill color; pass 0 for an outline only.
+ * @param border Border width in pixels, drawn inside min and max; 0 for none.
+ * @param border_color Border color.
+ */
+void imsdl_draw_rounded_rect(
+    IMSDL_DrawList* list,
+    IMSDL_Vec2 min,
+    IMSDL_Vec2 max,
+    float radius,
+    uint32_t fill,
+    float border,
+    uint32_t border_color
+);
+
+/**
+ * @brief Appends a filled axis-aligned rectangle.
+ */
+void imsdl_draw_rect_filled(IMSDL_DrawList* list, IMSDL_Vec2 min, IMSDL_Vec2 max, uint32_t color);
+
+/**
+ * @brief Appends a rectangle outline drawn inside min and max.
+ */
+void imsdl_draw_rect(
+    IMSDL_DrawList* list, IMSDL_Vec2 min, IMSDL_Vec2 max, uint32_t color, float thickness
+);
+
+/**
+ * @brief Appends a line segment of the given thickness.
+ */
+void imsdl_draw_line(
+    IMSDL_DrawList* list, IMSDL_Vec2 a, IMSDL_Vec2 b, uint32_t color, float thickness
+);
+
+/**
+ * @brief Appends a filled triangle.
+ */
+void imsdl_draw_triangle_filled(
+    IMSDL_DrawList* list, IMSDL_Vec2 a, IMSDL_Vec2 b, IMSDL_Vec2 c, uint32_t color
+);
+
+/**
+ * @brief Appends a textured quad.
+ *
+ * @param texture The GL texture name to sample.
+ * @param min Top-left corner in pixels.
+ * @param max Bottom-right corner in pixels.
+ * @param uv_min Texture coordinates at min.
+ * @param uv_max Texture coordinates at max.
+ * @param color Tint multiplied with the texture.
+ */
+void imsdl_draw_image(
+    IMSDL_DrawList* list,
+    uint32_t texture,
+    IMSDL_Vec2 min,
+    IMSDL_Vec2 max,
+    IMSDL_Vec2 uv_min,
+    IMSDL_Vec2 uv_max,
+    uint32_t color
+);
+
+#endif // IMSDL_DRAW_H
@@ -17,7 +17,9 @@
 #include <errno.h>
 #include <pthread.h> // For including mutex functions
 #include <stdarg.h> // For variadic function support
+#include <stdatomic.h> // For lock-free level checks
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h> // For memory allocation support
 #include <string.h> // Include for strerror declaration
@@ -37,36 +39,160 @@ typedef enum LogLevel {
     LOG_LEVEL_ERROR
 } LogLevel;
 
+/**
+ * @brief Lowest log level compiled into the program.
+ *
+ * Log sites below this level expand to a constant false: their arguments are
+ * still type checked but never evaluated, and the compiler removes the call.
+ * Set through the IMSDL_LOG_LEVEL CMake cache variable.
+ */
+#ifndef IMSDL_LOG_LEVEL_MIN
+    #define IMSDL_LOG_LEVEL_MIN LOG_LEVEL_DEBUG
+#endif
+
 /**
  * @brief Enumeration representing different types of logging.
  *
  * @param LOG_TYPE_UNKNOWN Unknown log type.
  * @param LOG_TYPE_STREAM Log to a stream (e.g., stdout or stderr).
  * @param LOG_TYPE_FILE Log to a file.
+ * @param LOG_TYPE_BINARY Log raw arguments to a file for offline formatting.
+ * @param LOG_TYPE_MAPPED Log to a memory-mapped file with size-based rotation.
  */
 typedef enum LogType {
     LOG_TYPE_UNKNOWN,
     LOG_TYPE_STREAM,
-    LOG_TYPE_FILE
+    LOG_TYPE_FILE,
+    LOG_TYPE_BINARY,
+    LOG_TYPE_MAPPED
 } LogType;
 
+/**
+ * @brief Enumeration representing how a printf conversion reads its argument.
+ *
+ * Integer, double, and pointer arguments are stored as 8 bytes in binary
+ * logs, long double as 16 bytes, and strings as a 32-bit length followed by
+ * their bytes.
+ */
+typedef enum LogArgType {
+    LOG_ARG_NONE,
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LLONG,
+    LOG_ARG_SIZE,
+    LOG_ARG_INTMAX,
+    LOG_ARG_PTRDIFF,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_LDOUBLE,
+    LOG_ARG_STRING,
+    LOG_ARG_POINTER
+} LogArgType;
+
+/**
+ * @brief A single conversion specification within a format string.
+ *
+ * @param start Pointer to the '%' that begins the conversion.
+ * @param length Length of the conversion including the '%'.
+ * @param width LOG_ARG_INT if the width is '*', LOG_ARG_NONE otherwise.
+ * @param precision LOG_ARG_INT if the precision is '*', LOG_ARG_NONE otherwise.
+ * @param value How the converted argument is read, LOG_ARG_NONE for "%%".
+ */
+typedef struct LogFormatSpec {
+    const char* start;
+    size_t length;
+    LogArgType width;
+    LogArgType precision;
+    LogArgType value;
+} LogFormatSpec;
+
+/**
+ * @brief Magic bytes at the start of a binary log file.
+ */
+#define LOG_BINARY_MAGIC "IMSDLLOG"
+
+/**
+ * @brief Version of the binary log record layout.
+ */
+#define LOG_BINARY_VERSION 1
+
+/**
+ * @brief Opaque buffer used for binary logging.
+ */
+typedef struct LogBinary LogBinary;
+
+/**
+ * @brief Default size of each LOG_TYPE_MAPPED file in bytes.
+ */
+#define LOG_MAPPED_FILE_SIZE ((size_t) 16 * 1024 * 1024)
+
+/**
+ * @brief Default number of LOG_TYPE_MAPPED files kept, including the active one.
+ */
+#define LOG_MAPPED_FILE_COUNT 4
+
+/**
+ * @brief Opaque memory-mapped output used by LOG_TYPE_MAPPED.
+ *
+ * The active file is sized up front and mapped shared, so a message is a
+ * memcpy into the page cache: no syscall per message, and everything
+ * written survives a crash of the process. Unused space reads as NUL bytes
+ * until the file is closed or rotated, when it is truncated to its contents.
+ * A file left by an earlier run is trimmed and rotated to "<path>.1" when the
+ * logger first opens, so a restart after a crash keeps the crashed run's log.
+ */
+typedef struct LogMapped LogMapped;
+
+/**
+ * @brief Enumeration representing what asynchronous logging does when its
+ * ring buffer is full.
+ *
+ * @param LOG_OVERFLOW_DROP Discard the message and count it; the writer
+ * reports the number of dropped messages once space is available again.
+ * @param LOG_OVERFLOW_BLOCK Yield until the writer frees a slot.
+ */
+typedef enum LogOverflow {
+    LOG_OVERFLOW_DROP,
+    LOG_OVERFLOW_BLOCK
+} LogOverflow;
+
+/**
+ * @brief Maximum length of a single asynchronous log message, including the
+ * level prefix. Longer messages are truncated.
+ */
+#define LOG_RING_MESSAGE_SIZE 512
+
+/**
+ * @brief Opaque ring buffer used for asynchronous logging.
+ */
+typedef struct LogRing LogRing;
+
 /**
  * @brief Structure representing a logger object.
  *
- * @param log_level The logging level of the logger.
+ * @param log_level The logging level of the logger, read without locking.
  * @param log_type The type of logger.
  * @param log_type_name The name associated with the logger type.
  * @param file_stream The file stream for writing log messages.
  * @param file_path The path to the log file.
  * @param thread_lock Mutex to ensure thread-safe logging.
+ * @param ring Ring buffer drained by a writer thread, or NULL when logging
+ * synchronously.
+ * @param ring_users Producers currently pushing to ring; logger_stop_async
+ * waits for them before freeing it.
+ * @param binary Record buffer for LOG_TYPE_BINARY, created on first use.
+ * @param mapped Mapped output for LOG_TYPE_MAPPED, created on first use.
  */
 typedef struct Logger {
-    LogLevel log_level;
+    _Atomic LogLevel log_level;
     LogType log_type;
     const char* log_type_name;
     FILE* file_stream;
     const char* file_path;
     pthread_mutex_t thread_lock;
+    LogRing* _Atomic ring;
+    _Atomic size_t ring_users;
+    LogBinary* binary;
+    LogMapped* mapped;
 } Logger;
 
 /**
@@ -133,6 +259,23 @@ Logger* logger_new(LogType log_type);
  */
 Logger* logger_create(LogLevel log_level, LogType log_type, const char* file_path);
 
+/**
+ * @brief Sets the rotation limits of a LOG_TYPE_MAPPED logger.
+ *
+ * When a message does not fit in the active file, the file is truncated to
+ * its contents and renamed to "<path>.1", older files shift up by one, and
+ * the oldest beyond max_files is removed. Call before logger_start_async or
+ * after logger_stop_async; the writer thread owns the file in between.
+ *
+ * @param logger The logger to configure.
+ * @param max_file_size The size of each file in bytes.
+ * @param max_files The number of files kept, including the active one.
+ *
+ * @return True if the limits were applied, false if the logger is not a
+ * mapped logger, is asynchronous, or the active file could not be reopened.
+ */
+bool logger_set_rotation(Logger* logger, size_t max_file_size, size_t max_files);
+
 /**
  * @brief Destroys a logger instance and releases associated resources.
  *
@@ -144,6 +287,54 @@ Logger* logger_create(LogLevel log_level, LogType log_type, const char* file_pat
  */
 bool logger_free(Logger* logger);
 
+/**
+ * @brief Finds the next conversion specification in a printf format string.
+ *
+ * Shared by the binary logger, which records arguments according to the
+ * format, and by the offline decoder, which replays them.
+ *
+ * @param format The format string to scan.
+ * @param spec Receives the conversion that was found.
+ *
+ * @return A pointer just past the conversion, or NULL if there is none.
+ */
+const char* log_format_next(const char* format, LogFormatSpec* spec);
+
+/**
+ * @brief Writes buffered binary log records to the logger's file.
+ *
+ * Binary loggers buffer records in memory and only write when the buffer
+ * fills, so call this before reading the log while the program is running.
+ *
+ * @param logger The logger to flush. Does nothing for text loggers.
+ */
+void logger_flush_binary(Logger* logger);
+
+/**
+ * @brief Sets the runtime log level of a logger.
+ *
+ * Safe to call while other threads are logging.
+ *
+ * @param logger The logger to update.
+ * @param log_level The lowest level that will be logged.
+ */
+void logger_set_level(Logger* logger, LogLevel log_level);
+
+/**
+ * @brief Checks whether a message at log_level would be logged.
+ *
+ * A single relaxed atomic load, so disabled log sites cost one branch and
+ * never evaluate their arguments.
+ *
+ * @param logger The logger to query.
+ * @param log_level The level of the message.
+ *
+ * @return True if the message passes the logger's runtime level.
+ */
+static inline bool logger_enabled(Logger* logger, LogLevel log_level) {
+    return log_level >= atomic_load_explicit(&logger->log_level, memory_order_relaxed);
+}
+
 /**
  * @brief Logs a message with the specified log level to the logger's file.
  *
@@ -160,6 +351,66 @@ bool logger_free(Logger* logger);
  */
 bool logger_message(Logger* logger, LogLevel log_level, const char* format, ...);
 
+/**
+ * @brief Switches a logger to asynchronous mode.
+ *
+ * Producers format each message into a slot of a lock-free multi-producer,
+ * single-consumer ring buffer and return immediately. A dedicated writer
+ * thread drains the ring and writes messages in large batches with a
+ * single flush per batch, so callers never wait on disk I/O.
+ *
+ * LOG_TYPE_BINARY loggers are not supported: they already defer formatting
+ * and buffer their records, and the ring only carries formatted text.
+ *
+ * @param logger The logger to switch.
+ * @param capacity The number of message slots, rounded up to a power of 2.
+ * @param overflow What to do when the ring is full.
+ *
+ * @return True if the writer thread was started, false if the logger is
+ * already asynchronous, is a binary logger, or the thread cannot start.
+ */
+bool logger_start_async(Logger* logger, size_t capacity, LogOverflow overflow);
+
+/**
+ * @brief Drains pending messages, stops the writer thread, and switches the
+ * logger back to synchronous mode.
+ *
+ * Safe while other threads are logging: messages already being pushed are
+ * waited for, and later ones are written synchronously. logger_flush and
+ * logger_dropped must not run concurrently with this call.
+ *
+ * @param logger The logger to switch.
+ *
+ * @return True if the logger was asynchronous and has been stopped.
+ */
+bool logger_stop_async(Logger* logger);
+
+/**
+ * @brief Blocks until every message queued so far has been written.
+ *
+ * @param logger The logger to flush. Does nothing for synchronous loggers.
+ */
+void logger_flush(Logger* logger);
+
+/**
+ * @brief Returns the number of messages dropped because the ring was full.
+ */
+size_t logger_dropped(const Logger* logger);
+
+/**
+ * @brief Installs signal handlers that write pending asynchronous messages
+ * before the process dies.
+ *
+ * Handles SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT. The handler drains
+ * the ring with write(2), restores the default action, and re-raises the
+ * signal. Only one logger can be registered at a time.
+ *
+ * @param logger The logger whose ring should be drained on a crash.
+ *
+ * @return True if the handlers were installed, false otherwise.
+ */
+bool logger_install_crash_handler(Logger* logger);
+
 /**
  * @brief Macro for logging messages using a logger instance.
  *
@@ -167,6 +418,11 @@ bool logger_message(Logger* logger, LogLevel log_level, const char* format, ...)
  * logger instance. It calls the logger_message function with the specified
  * logger, log level, and message format.
  *
+ * Levels below IMSDL_LOG_LEVEL_MIN are removed at compile time. The rest
+ * are checked against the logger's runtime level before any argument is
+ * evaluated. The macro is a statement; call logger_message directly when the
+ * result is needed. The logger and level arguments may be evaluated twice.
+ *
  * @param logger A pointer to the logger instance to use for logging.
  * @param level The log level of the message to be logged.
  * @param format The format string of the message to be logged.
@@ -178,9 +434,133 @@ bool logger_message(Logger* logger, LogLevel log_level, const char* format, ...)
  * @endcode
  */
 #define LOG(logger, level, format, ...) \
-    logger_message( \
-        (logger), (level), "[%s:%s:%d] " format "\n", __FILE__, __func__, __LINE__, ##__VA_ARGS__ \
-    )
+    do { \
+        if ((int) (level) >= (int) IMSDL_LOG_LEVEL_MIN && logger_enabled((logger), (level))) { \
+            logger_message( \
+                (logger), \
+                (level), \
+                "[%s:%s:%d] " format "\n", \
+                __FILE__, \
+                __func__, \
+                __LINE__, \
+                ##__VA_ARGS__ \
+            ); \
+        } \
+    } while (0)
+
+/**
+ * @brief Per call site state for rate-limited logging.
+ *
+ * @param next_ns Monotonic time in nanoseconds before which the site stays
+ * quiet.
+ * @param suppressed Number of messages skipped since the site last logged.
+ * @param registered Set once the site is on the list walked by log_sites_flush.
+ * @param logger, level, file, func, line Where the site reports its
+ * suppressed count, filled in when it registers. logger_free clears logger,
+ * and the next logger to suppress a message from the site takes its place.
+ * @param next Next registered site.
+ */
+typedef struct LogSite {
+    _Atomic uint64_t next_ns;
+    _Atomic uint32_t suppressed;
+    _Atomic bool registered;
+    Logger* _Atomic logger;
+    LogLevel level;
+    const char* file;
+    const char* func;
+    int line;
+    struct LogSite* next;
+} LogSite;
+
+/**
+ * @brief Decides whether a rate-limited site may log now.
+ *
+ * Lock-free: concurrent callers race on a compare-and-swap and the losers
+ * count as suppressed. The first suppression registers the site so
+ * log_sites_flush can report its count if the site goes quiet.
+ *
+ * @param site The call site's state; must have static storage duration.
+ * @param logger, level, file, func, line Identify the site in its report.
+ * @param interval_ns Minimum time between two messages from the site.
+ * @param suppressed Receives the number of messages skipped since the last
+ * one that was allowed.
+ *
+ * @return True if the message should be logged.
+ */
+bool log_site_allow(
+    LogSite* site,
+    Logger* logger,
+    LogLevel level,
+    const char* file,
+    const char* func,
+    int line,
+    uint64_t interval_ns,
+    uint32_t* suppressed
+);
+
+/**
+ * @brief Logs "Last message repeated N times" for sites with suppressed messages.
+ *
+ * The async writer calls this for its own logger as intervals end, and
+ * logger_stop_async and logger_free call it with force set, so a burst followed by silence still
+ * reports its count. Synchronous loggers have no timer and report on the
+ * site's next message, on logger_free, or when the caller flushes.
+ *
+ * @param logger Only flush sites logging to this logger, or NULL for all.
+ * @param force Report counts even if the site's interval has not ended.
+ */
+void log_sites_flush(Logger* logger, bool force);
+
+/**
+ * @brief Macro for logging at most once per interval from a call site.
+ *
+ * Each expansion owns a static LogSite, so noisy sites are throttled
+ * independently and without a global lock. The first message is logged
+ * immediately; later ones within interval_ms are folded into a count. The
+ * count is appended to the next message that gets through, or logged on its
+ * own by log_sites_flush once the interval ends.
+ *
+ * The site's state is shared by every logger passed to it, and its own
+ * count report goes to the first of them. Use one long-lived logger per
+ * site; logger_free detaches the site so it never reports to a freed logger.
+ *
+ * @param logger A pointer to the logger instance to use for logging.
+ * @param level The log level of the message to be logged.
+ * @param interval_ms Minimum time between two messages from this site.
+ * @param format The format string of the message to be logged.
+ * @param ... Additional arguments for formatting the message (optional).
+ *
+ * Example usage:
+ * @code{.c}
+ * LOG_RATELIMIT(my_logger, LOG_LEVEL_INFO, 250, "Mouse: x=%d, y=%d", x, y);
+ * @endcode
+ */
+#define LOG_RATELIMIT(logger, level, interval_ms, format, ...) \
+    do { \
+        static LogSite log_site_; \
+        uint32_t log_suppressed_ = 0; \
+        if ((int) (level) >= (int) IMSDL_LOG_LEVEL_MIN && logger_enabled((logger), (level)) \
+            && log_site_allow( \
+                &log_site_, \
+                (logger), \
+                (level), \
+                __FILE__, \
+                __func__, \
+                __LINE__, \
+                (uint64_t) (interval_ms) * 1000000u, \
+                &log_suppressed_ \
+            )) { \
+            if (log_suppressed_ > 0) { \
+                LOG((logger), \
+                    (level), \
+                    format " (last message repeated %u times)", \
+                    ##__VA_ARGS__, \
+                    log_suppressed_); \
+            } else { \
+                LOG((logger), (level), format, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
 
 /**
  * @brief Global Logger Object
@@ -257,4 +637,25 @@ void initialize_global_logger(
 #define LOG_WARN(format, ...) LOG(&global_logger, LOG_LEVEL_WARN, format, ##__VA_ARGS__)
 #define LOG_ERROR(format, ...) LOG(&global_logger, LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
 
+/**
+ * @brief Convenience macros for rate-limited logging with the global logger.
+ *
+ * @param interval_ms Minimum time between two messages from the call site.
+ * @param format The format string for the log message.
+ * @param ... Additional arguments for formatting the message (optional).
+ *
+ * Example usage:
+ * @code{.c}
+ * LOG_INFO_RATELIMIT(250, "Mouse: x=%d, y=%d", x, y);
+ * @endcode
+ */
+#define LOG_DEBUG_RATELIMIT(interval_ms, format, ...) \
+    LOG_RATELIMIT(&global_logger, LOG_LEVEL_DEBUG, interval_ms, format, ##__VA_ARGS__)
+#define LOG_INFO_RATELIMIT(interval_ms, format, ...) \
+    LOG_RATELIMIT(&global_logger, LOG_LEVEL_INFO, interval_ms, format, ##__VA_ARGS__)
+#define LOG_WARN_RATELIMIT(interval_ms, format, ...) \
+    LOG_RATELIMIT(&global_logger, LOG_LEVEL_WARN, interval_ms, format, ##__VA_ARGS__)
+#define LOG_ERROR_RATELIMIT(interval_ms, format, ...) \
+    LOG_RATELIMIT(&global_logger, LOG_LEVEL_ERROR, interval_ms, format, ##__VA_ARGS__)
+
 #endif // IMSDL_LOGGER_H
@@ -0,0 +1,149 @@
+/**
+ * @file include/memstat.h
+ * @brief Optional allocator statistics and high-water-mark instrumentation.
+ *
+ * Statistics are only collected when the project is built with
+ * IMSDL_MEMSTAT defined (see the IMSDL_MEMSTAT CMake option). Otherwise the
+ * MEMSTAT_* macros compile away and allocators pay nothing.
+ */
+
+#ifndef IMSDL_MEMSTAT_H
+#define IMSDL_MEMSTAT_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+// Maximum number of distinct call sites tracked
+#define MEMSTAT_SITE_COUNT 256
+
+/**
+ * @struct MemStat
+ * @brief Counters for a single allocator.
+ */
+typedef struct MemStat {
+    const char* name; // Label used when dumping statistics
+    _Atomic size_t live_bytes; // Bytes currently allocated
+    _Atomic size_t peak_bytes; // Highest value live_bytes has reached
+    _Atomic size_t alloc_count; // Total number of allocations
+    _Atomic size_t free_count; // Total number of releases
+    _Atomic size_t frame_allocs; // Allocations made during the current frame
+    _Atomic size_t frame_bytes; // Bytes allocated during the current frame
+    _Atomic size_t last_frame_allocs; // Allocations made during the previous frame
+    _Atomic size_t last_frame_bytes; // Bytes allocated during the previous frame
+    struct MemStat* next; // Next registered allocator
+} MemStat;
+
+/**
+ * @struct MemStatInfo
+ * @brief A plain snapshot of an allocator's counters.
+ */
+typedef struct MemStatInfo {
+    const char* name;
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t alloc_count;
+    size_t free_count;
+    size_t last_frame_allocs;
+    size_t last_frame_bytes;
+} MemStatInfo;
+
+/**
+ * @struct MemStatSite
+ * @brief Allocation totals for a single call site.
+ */
+typedef struct MemStatSite {
+    const char* file;
+    int line;
+    size_t alloc_count;
+    size_t alloc_bytes;
+} MemStatSite;
+
+// Statistics for aligned_malloc and aligned_free
+extern MemStat memstat_aligned;
+
+/**
+ * @brief Initializes a stat and adds it to the global registry.
+ */
+void memstat_register(MemStat* stat, const char* name);
+
+/**
+ * @brief Removes a stat from the global registry.
+ */
+void memstat_unregister(MemStat* stat);
+
+/**
+ * @brief Records an allocation of size bytes.
+ */
+void memstat_alloc(MemStat* stat, size_t size);
+
+/**
+ * @brief Records a release of size bytes.
+ */
+void memstat_free(MemStat* stat, size_t size);
+
+/**
+ * @brief Sets the live byte count directly, for allocators that release in bulk.
+ */
+void memstat_set_live(MemStat* stat, size_t live_bytes);
+
+/**
+ * @brief Records an allocation against its call site and returns ptr unchanged.
+ */
+void* memstat_site(void* ptr, size_t size, const char* file, int line);
+
+/**
+ * @brief Ends the frame for every registered allocator.
+ *
+ * Moves the current frame counters into the last frame counters and clears them.
+ */
+void memstat_frame_end(void);
+
+/**
+ * @brief Copies a stat's counters into info.
+ */
+void memstat_query(const MemStat* stat, MemStatInfo* info);
+
+/**
+ * @brief Sums the counters of every registered allocator into info.
+ *
+ * Peaks are summed per allocator, so peak_bytes bounds the combined peak.
+ */
+void memstat_query_total(MemStatInfo* info);
+
+/**
+ * @brief Copies up to max_sites call sites into sites.
+ *
+ * @return The number of sites copied.
+ */
+size_t memstat_sites(MemStatSite* sites, size_t max_sites);
+
+/**
+ * @brief Logs the counters of every registered allocator.
+ */
+void memstat_log(void);
+
+/**
+ * @brief Logs the allocation totals of every tracked call site.
+ */
+void memstat_log_sites(void);
+
+/**
+ * @brief Instrumentation hooks that compile away unless IMSDL_MEMSTAT is defined.
+ */
+#ifdef IMSDL_MEMSTAT
+    #define MEMSTAT_REGISTER(stat, name) memstat_register((stat), (name))
+    #define MEMSTAT_UNREGISTER(stat) memstat_unregister((stat))
+    #define MEMSTAT_ALLOC(stat, size) memstat_alloc((stat), (size))
+    #define MEMSTAT_FREE(stat, size) memstat_free((stat), (size))
+    #define MEMSTAT_SET_LIVE(stat, live_bytes) memstat_set_live((stat), (live_bytes))
+    #define MEMSTAT_FRAME_END() memstat_frame_end()
+#else
+    #define MEMSTAT_REGISTER(stat, name) ((void) 0)
+    #define MEMSTAT_UNREGISTER(stat) ((void) 0)
+    #define MEMSTAT_ALLOC(stat, size) ((void) 0)
+    #define MEMSTAT_FREE(stat, size) ((void) 0)
+    #define MEMSTAT_SET_LIVE(stat, live_bytes) ((void) 0)
+    #define MEMSTAT_FRAME_END() ((void) 0)
+#endif
+
+#endif // IMSDL_MEMSTAT_H
@@ -0,0 +1,83 @@
+/**
+ * @file include/pool.h
+ * @brief A fixed-size pool allocator with an intrusive free list.
+ *
+ * The pool carves uniform slots out of large aligned slabs. Released slots
+ * are threaded onto a free list through their own storage, so acquire and
+ * release are O(1) and no per-object header is needed.
+ */
+
+#ifndef IMSDL_POOL_H
+#define IMSDL_POOL_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "memstat.h"
+
+// Default slot alignment, matching a typical cache line
+#define POOL_CACHE_LINE 64
+
+/**
+ * @struct PoolSlab
+ * @brief Header placed at the start of each slab to chain them for freeing.
+ */
+typedef struct PoolSlab {
+    struct PoolSlab* next; // Previously allocated slab, or NULL
+} PoolSlab;
+
+/**
+ * @struct Pool
+ * @brief A fixed-size pool allocator.
+ */
+typedef struct Pool {
+    PoolSlab* slabs; // Most recently allocated slab
+    void* free_list; // Released slots, linked through their first word
+    uint8_t* cursor; // Next never-used slot in the newest slab
+    uint8_t* end; // End of the newest slab
+    size_t slot_size; // Size of each slot in bytes, a multiple of alignment
+    size_t alignment; // Alignment of each slot
+    size_t slots_per_slab; // Number of slots carved from each slab
+    size_t count; // Number of slots currently acquired
+    MemStat stat; // Allocation statistics, only updated with IMSDL_MEMSTAT
+} Pool;
+
+/**
+ * @brief Creates a pool.
+ *
+ * @param slot_size The size of each object in bytes.
+ * @param slots_per_slab The number of slots allocated at once when the pool grows.
+ * @param alignment The slot alignment, must be a power of 2, or 0 for POOL_CACHE_LINE.
+ * @return A pointer to the pool, or NULL if allocation fails.
+ */
+Pool* pool_create(size_t slot_size, size_t slots_per_slab, size_t alignment);
+
+/**
+ * @brief Frees a pool and every slab it owns.
+ *
+ * @note Slots still acquired become invalid.
+ */
+void pool_free(Pool* pool);
+
+/**
+ * @brief Acquires an uninitialized slot from the pool.
+ *
+ * @return A pointer to the slot, or NULL if allocation fails.
+ */
+void* pool_acquire(Pool* pool);
+
+/**
+ * @brief Returns a slot to the pool.
+ *
+ * @param slot A pointer returned by pool_acquire on the same pool, or NULL.
+ */
+void pool_release(Pool* pool, void* slot);
+
+#ifdef IMSDL_MEMSTAT
+    // Attribute each acquire to its call site
+    #define pool_acquire(pool) \
+        memstat_site(pool_acquire((pool)), (pool)->slot_size, __FILE__, __LINE__)
+#endif
+
+#endif // IMSDL_POOL_H
@@ -0,0 +1,168 @@
+/**
+ * @file include/profile.h
+ * @brief Optional frame timing: CPU zones, GPU timer queries and counters.
+ *
+ * Timings are only collected when the project is built with IMSDL_PROFILE
+ * defined (see the IMSDL_PROFILE CMake option). Otherwise the PROFILE_*
+ * macros compile away and the render loop pays nothing.
+ *
+ * Zones and GPU queries belong to the render thread. Counters may be bumped
+ * from any thread.
+ */
+
+#ifndef IMSDL_PROFILE_H
+#define IMSDL_PROFILE_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Maximum number of distinct zones tracked
+#define PROFILE_ZONE_COUNT 32
+
+// Number of frames kept for percentiles
+#define PROFILE_HISTORY 512
+
+// Number of GPU timer queries in flight; results are read this many frames late
+#define PROFILE_GPU_LATENCY 4
+
+/**
+ * @brief Per-frame counters.
+ */
+typedef enum ProfileCounter {
+    PROFILE_COUNTER_DRAW_CALLS,
+    PROFILE_COUNTER_VERTICES,
+    PROFILE_COUNTER_INDICES,
+    PROFILE_COUNTER_RECTS,
+    PROFILE_COUNTER_ALLOCATIONS,
+    PROFILE_COUNTER_COUNT
+} ProfileCounter;
+
+/**
+ * @struct ProfileZone
+ * @brief Accumulated time of a named region of code.
+ */
+typedef struct ProfileZone {
+    const char* name; // Label used when dumping statistics
+    uint64_t frame_ns; // Time spent in the zone during the current frame
+    uint64_t last_frame_ns; // Time spent in the zone during the previous frame
+    uint64_t total_ns; // Time spent in the zone since startup
+    uint64_t calls; // Number of times the zone was entered since startup
+} ProfileZone;
+
+/**
+ * @struct ProfileStats
+ * @brief Frame time percentiles over the last PROFILE_HISTORY frames.
+ */
+typedef struct ProfileStats {
+    uint64_t frames; // Frames ended since startup
+    size_t cpu_samples; // CPU frame times in the window
+    double cpu_p50_ms;
+    double cpu_p99_ms;
+    double cpu_max_ms;
+    size_t gpu_samples; // GPU frame times in the window, 0 without timer queries
+    double gpu_p50_ms;
+    double gpu_p99_ms;
+    double gpu_max_ms;
+    uint64_t counters[PROFILE_COUNTER_COUNT]; // Counters of the previous frame
+} ProfileStats;
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+uint64_t profile_now_ns(void);
+
+/**
+ * @brief Registers the zone on first use and returns the current time.
+ *
+ * @param zone Caches the zone between calls; starts out NULL.
+ */
+uint64_t profile_zone_begin(ProfileZone** zone, const char* name);
+
+/**
+ * @brief Adds the time since start to the zone.
+ */
+void profile_zone_end(ProfileZone* zone, uint64_t start);
+
+/**
+ * @brief Adds amount to a counter of the current frame.
+ */
+void profile_count(ProfileCounter counter, uint64_t amount);
+
+/**
+ * @brief Marks the start of the frame's CPU work.
+ *
+ * Without it, the frame is timed from the end of the previous one.
+ */
+void profile_frame_begin(void);
+
+/**
+ * @brief Records the frame time and rolls zones and counters to the next frame.
+ */
+void profile_frame_end(void);
+
+/**
+ * @brief Starts timing the frame's GL commands with GL_TIME_ELAPSED.
+ *
+ * Requires a current GL context. Results are collected PROFILE_GPU_LATENCY
+ * frames later; if one is not ready, that frame is not timed rather than
+ * waited on.
+ */
+void profile_gpu_begin(void);
+
+/**
+ * @brief Stops timing the frame's GL commands.
+ */
+void profile_gpu_end(void);
+
+/**
+ * @brief Deletes the timer queries; call before the GL context is destroyed.
+ */
+void profile_gpu_shutdown(void);
+
+/**
+ * @brief Computes percentiles and copies the previous frame's counters.
+ */
+void profile_query(ProfileStats* stats);
+
+/**
+ * @brief Copies up to max_zones zones into zones.
+ *
+ * @return The number of zones copied.
+ */
+size_t profile_zones(ProfileZone* zones, size_t max_zones);
+
+/**
+ * @brief Logs frame time percentiles, counters and zone timings.
+ */
+void profile_log(void);
+
+/**
+ * @brief Instrumentation hooks that compile away unless IMSDL_PROFILE is defined.
+ *
+ * PROFILE_ZONE_BEGIN(name) and PROFILE_ZONE_END(name) must be paired in the
+ * same block; name is a bare identifier.
+ */
+#ifdef IMSDL_PROFILE
+    #define PROFILE_ZONE_BEGIN(name) \
+        static ProfileZone* profile_zone_##name = NULL; \
+        uint64_t profile_start_##name = profile_zone_begin(&profile_zone_##name, #name)
+    #define PROFILE_ZONE_END(name) profile_zone_end(profile_zone_##name, profile_start_##name)
+    #define PROFILE_COUNT(counter, amount) profile_count((counter), (amount))
+    #define PROFILE_FRAME_BEGIN() profile_frame_begin()
+    #define PROFILE_FRAME_END() profile_frame_end()
+    #define PROFILE_GPU_BEGIN() profile_gpu_begin()
+    #define PROFILE_GPU_END() profile_gpu_end()
+    #define PROFILE_GPU_SHUTDOWN() profile_gpu_shutdown()
+#else
+    #define PROFILE_ZONE_BEGIN(name) ((void) 0)
+    #define PROFILE_ZONE_END(name) ((void) 0)
+    #define PROFILE_COUNT(counter, amount) ((void) 0)
+    #define PROFILE_FRAME_BEGIN() ((void) 0)
+    #define PROFILE_FRAME_END() ((void) 0)
+    #define PROFILE_GPU_BEGIN() ((void) 0)
+    #define PROFILE_GPU_END() ((void) 0)
+    #define PROFILE_GPU_SHUTDOWN() ((void) 0)
+#endif
+
+#endif // IMSDL_PROFILE_H
@@ -0,0 +1,126 @@
+/**
+ * @file include/raster.h
+ * @brief CPU rasterizer for the draw list.
+ *
+ * Renders a draw list into 32-bit pixels without OpenGL, for machines where
+ * only a slow general-purpose software GL is available. The target is split
+ * into square tiles. Primitives are binned to the tiles they touch in
+ * submission order, then worker threads claim whole tiles, so no two threads
+ * ever write the same pixel and no locking is needed while drawing.
+ *
+ * Rect instances are shaded with the same rounded-box distance function as
+ * the GL path, several pixels at a time with SSE2 or AVX2, picked at runtime.
+ * Fully covered opaque spans are filled without shading. Triangles are
+ * rasterized with edge functions and Gouraud-shaded vertex colors; textures
+ * live in GL and are not sampled, so textured triangles draw as their tint.
+ */
+
+#ifndef IMSDL_RASTER_H
+#define IMSDL_RASTER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "draw.h"
+
+// Width and height of a tile in pixels
+#define IMSDL_RASTER_TILE_SIZE 64
+
+// Upper bound on worker threads, not counting the calling thread
+#define IMSDL_RASTER_MAX_THREADS 16
+
+/**
+ * @struct IMSDL_RasterRect
+ * @brief A rect instance prepared for shading.
+ */
+typedef struct IMSDL_RasterRect {
+    float cx, cy; // Center in pixels
+    float hx, hy; // Half size in pixels
+    float radius; // Clamped corner radius
+    float border; // Border width
+    float fill[4]; // Premultiplied fill, channels in target byte order, 0 to 255
+    float edge[4]; // Premultiplied border, equal to fill when there is no border
+    int x0, y0, x1, y1; // Pixels touched, clipped to the target, exclusive max
+    int solid_x0, solid_y0, solid_x1, solid_y1; // Opaque interior, empty if not opaque
+    uint32_t solid; // Packed fill written to the opaque interior
+} IMSDL_RasterRect;
+
+// Shades count pixels of one row of a rect, starting at pixel (x, y)
+typedef void (*IMSDL_RasterSpan)(uint32_t* row, int count, int x, int y, const IMSDL_RasterRect*);
+
+/**
+ * @struct IMSDL_Raster
+ * @brief Tile bins, worker threads and the kernel chosen for this CPU.
+ */
+typedef struct IMSDL_Raster {
+    IMSDL_RasterSpan span; // Widest rect kernel the CPU supports
+    const char* kernel; // Name of span, for logging
+    bool swap_rb; // Target stores blue in the low byte
+
+    // Frame being drawn
+    const IMSDL_DrawList* list;
+    uint32_t* pixels;
+    size_t pitch; // Distance between rows, in pixels
+    int width;
+    int height;
+    uint32_t clear; // Packed clear color in target byte order
+
+    // Binning: tile t owns bins[offsets[t] .. offsets[t + 1])
+    int tiles_x;
+    int tiles_y;
+    uint32_t* offsets;
+    uint32_t* cursors;
+    size_t tile_capacity;
+    uint32_t* bins; // Rect index, or first index of a triangle with the top bit set
+    size_t bin_capacity;
+    IMSDL_RasterRect* rects;
+    size_t rect_capacity;
+
+    // Workers wait for a new generation, then claim tiles until none are left
+    pthread_t threads[IMSDL_RASTER_MAX_THREADS];
+    int thread_count;
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+    uint64_t generation;
+    int busy; // Workers still drawing the current generation
+    bool stop;
+    _Atomic uint32_t next_tile;
+} IMSDL_Raster;
+
+/**
+ * @brief Creates a rasterizer and starts its worker threads.
+ *
+ * @param threads Worker threads besides the caller, or -1 for one per
+ * online CPU minus one. 0 draws everything on the calling thread.
+ * @return A pointer to the rasterizer, or NULL on failure.
+ */
+IMSDL_Raster* imsdl_raster_create(int threads);
+
+/**
+ * @brief Stops the workers and frees the rasterizer.
+ */
+void imsdl_raster_free(IMSDL_Raster* raster);
+
+/**
+ * @brief Clears the target and draws the list into it.
+ *
+ * @param pixels Target pixels, 4 bytes each, R in the low byte unless swap_rb.
+ * @param pitch Distance between rows in pixels.
+ * @param clear Clear color packed with IMSDL_RGBA.
+ * @return False if the bins cannot be allocated; the target is left as is.
+ */
+bool imsdl_raster_render(
+    IMSDL_Raster* raster,
+    const IMSDL_DrawList* list,
+    uint32_t* pixels,
+    size_t pitch,
+    int width,
+    int height,
+    uint32_t clear
+);
+
+#endif // IMSDL_RASTER_H
@@ -8,8 +8,91 @@
 
 #include <GL/glew.h>
 
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Directory for cached program binaries; set it empty to disable the cache.
+// Defaults to $XDG_CACHE_HOME/imsdl, or $HOME/.cache/imsdl.
+#define IMSDL_SHADER_CACHE_ENV "IMSDL_SHADER_CACHE"
+
+// Directory whose files replace the embedded shaders of the same name.
+// They are mapped rather than copied, so shaders can be edited without a rebuild.
+#define IMSDL_SHADER_DIR_ENV "IMSDL_SHADER_DIR"
+
+// A file from shaders/ compiled into the binary
+typedef struct IMSDL_ShaderSource {
+    const char* name; // File name, such as "vertex.glsl"
+    const char* text; // NUL-terminated
+    size_t size; // Bytes of text, excluding the terminator
+} IMSDL_ShaderSource;
+
+// Generated from shaders/*.glsl at build time, sorted by name
+extern const IMSDL_ShaderSource imsdl_shader_sources[];
+extern const size_t imsdl_shader_source_count;
+
+// Shader text borrowed from the embedded table or a mapped override file
+typedef struct IMSDL_ShaderText {
+    const char* data; // Not NUL-terminated when mapped
+    size_t size;
+    bool mapped; // Unmapped by imsdl_release_shader
+} IMSDL_ShaderText;
+
+// Reads a whole file into a NUL-terminated buffer the caller frees; NULL on failure
 char* imsdl_read_shader(const char* filepath);
+
+// Finds a shader by file name without copying it; logs and returns false if unknown
+bool imsdl_load_shader(const char* name, IMSDL_ShaderText* text);
+void imsdl_release_shader(IMSDL_ShaderText* text);
+
 GLuint imsdl_compile_shader(const char* source, GLenum type);
-GLuint imsdl_create_shader_program(const char* vertex_file, const char* fragment_file);
+
+// Both sources of a program, loaded and hashed without GL so any thread can prepare them
+typedef struct IMSDL_ShaderProgramSource {
+    const char* vertex_name;
+    const char* fragment_name;
+    IMSDL_ShaderText vertex;
+    IMSDL_ShaderText fragment;
+    uint64_t hash; // Sources only; the driver is mixed in when the build begins
+} IMSDL_ShaderProgramSource;
+
+// A program whose compile and link were submitted but not yet waited on
+typedef struct IMSDL_ShaderBuild {
+    GLuint program;
+    GLuint vertex_shader; // 0 once finished or when loaded from the cache
+    GLuint fragment_shader;
+    const char* vertex_name;
+    const char* fragment_name;
+    uint64_t key;
+    bool cache; // Store the binary once linked
+    char cache_path[PATH_MAX];
+} IMSDL_ShaderBuild;
+
+// Loads both shaders and hashes them; thread-safe and GL-free. Returns false if
+// a shader cannot be found. The source must outlive any build begun from it.
+bool imsdl_prepare_shader_program(
+    IMSDL_ShaderProgramSource* source, const char* vertex_name, const char* fragment_name
+);
+void imsdl_release_shader_program(IMSDL_ShaderProgramSource* source);
+
+// Loads the program from the binary cache, or submits compile and link without
+// waiting, so several programs can be begun before any is ended. The driver
+// builds them concurrently when GL_KHR_parallel_shader_compile is available.
+void imsdl_begin_shader_program(IMSDL_ShaderBuild* build, const IMSDL_ShaderProgramSource* source);
+
+// Waits for a begun program, logs any compile or link errors and stores the
+// binary in the cache. Returns the program.
+GLuint imsdl_end_shader_program(IMSDL_ShaderBuild* build);
+
+// Reads every cached program binary ahead into the page cache; GL-free, for
+// warming the cache on another thread before the context exists
+void imsdl_prefetch_shader_cache(void);
+
+// Builds a program from two shader names, such as "vertex.glsl". Loads it
+// from the binary cache when the sources and the GL vendor, renderer and
+// version all match; otherwise compiles, links and stores it. Returns 0 if
+// a shader cannot be found.
+GLuint imsdl_create_shader_program(const char* vertex_name, const char* fragment_name);
 
 #endif // IMSDL_SHADERS_H
@@ -0,0 +1,75 @@
+/**
+ * @file include/startup.h
+ * @brief Startup pipeline and timing breakdown.
+ *
+ * imsdl_startup_shaders_begin loads, hashes and faults in shader sources,
+ * and reads the program cache ahead, on a worker thread while the caller
+ * initializes SDL and GL. imsdl_startup_shaders_end then submits every
+ * program before waiting on any, so the driver can build them together.
+ *
+ * Startup stages on any thread are recorded with imsdl_startup_record and
+ * logged side by side by imsdl_startup_log, so overlap shows in the offsets.
+ */
+
+#ifndef IMSDL_STARTUP_H
+#define IMSDL_STARTUP_H
+
+#include "shaders.h"
+
+#include <GL/glew.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Stages kept until imsdl_startup_log; later ones are dropped
+#define IMSDL_STARTUP_STAGES 32
+
+// Programs one imsdl_startup_shaders_begin can prepare
+#define IMSDL_STARTUP_PROGRAMS 8
+
+/**
+ * @struct IMSDL_StartupShaders
+ * @brief Shader programs prepared on the startup worker.
+ */
+typedef struct IMSDL_StartupShaders {
+    pthread_t thread;
+    bool threaded; // False if the worker failed to start and the sources were prepared inline
+    size_t count;
+    const char* const (*names)[2]; // Vertex and fragment name per program
+    IMSDL_ShaderProgramSource sources[IMSDL_STARTUP_PROGRAMS];
+    bool prepared[IMSDL_STARTUP_PROGRAMS];
+} IMSDL_StartupShaders;
+
+/**
+ * @brief Records a stage that ran from start_ns (see profile_now_ns) until now.
+ *
+ * Thread-safe; cheap enough to leave in release builds.
+ */
+void imsdl_startup_record(const char* name, uint64_t start_ns);
+
+/**
+ * @brief Logs every recorded stage by start time, then the total, and clears them.
+ */
+void imsdl_startup_log(void);
+
+/**
+ * @brief Starts preparing count programs on a worker thread; needs no GL context.
+ *
+ * @param names Vertex and fragment shader names per program; must outlive the call to end.
+ */
+void imsdl_startup_shaders_begin(
+    IMSDL_StartupShaders* shaders, const char* const (*names)[2], size_t count
+);
+
+/**
+ * @brief Waits for the worker and builds every program on the current context.
+ *
+ * @param programs Receives count programs, 0 where a shader was missing; pass
+ * NULL to only release the sources, e.g. when no context could be created.
+ * @return False if any program is missing.
+ */
+bool imsdl_startup_shaders_end(IMSDL_StartupShaders* shaders, GLuint* programs);
+
+#endif // IMSDL_STARTUP_H
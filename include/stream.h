@@ -0,0 +1,92 @@
+/**
+ * @file include/stream.h
+ * @brief Streaming buffer for geometry that changes every frame.
+ *
+ * The buffer is split into IMSDL_STREAM_REGIONS regions used round-robin,
+ * one per frame in flight. A fence is inserted after the draws that read a
+ * region and waited on before the region is written again, so the CPU never
+ * overwrites data the GPU is still reading and the driver never has to
+ * synchronize or reallocate implicitly.
+ *
+ * The storage is immutable and mapped persistently and coherently, so pushes
+ * are plain memcpy into GPU-visible memory. This needs GL 4.4 or
+ * ARB_buffer_storage, which the viewport's 4.5 core context always provides.
+ */
+
+#ifndef IMSDL_STREAM_H
+#define IMSDL_STREAM_H
+
+#include <GL/glew.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Number of frames the CPU may run ahead of the GPU
+#define IMSDL_STREAM_REGIONS 3
+
+// Default size of each region in bytes
+#define IMSDL_STREAM_REGION_SIZE ((size_t) 4 * 1024 * 1024)
+
+/**
+ * @struct IMSDL_StreamBuffer
+ * @brief A buffer object written by the CPU once per frame.
+ */
+typedef struct IMSDL_StreamBuffer {
+    GLuint buffer; // Buffer object, usable as vertex and element buffer
+    uint8_t* mapped; // Persistent mapping of the whole buffer
+    size_t region_size; // Size of each region in bytes
+    size_t offset; // Bytes pushed into the current region
+    uint32_t region; // Region written this frame
+    GLsync fences[IMSDL_STREAM_REGIONS]; // Pending GPU reads per region, or NULL
+} IMSDL_StreamBuffer;
+
+/**
+ * @brief Creates a streaming buffer.
+ *
+ * Requires a current GL context.
+ *
+ * @param region_size The size of each region in bytes, or 0 for
+ * IMSDL_STREAM_REGION_SIZE.
+ * @return A pointer to the stream, or NULL if the buffer cannot be created.
+ */
+IMSDL_StreamBuffer* imsdl_stream_create(size_t region_size);
+
+/**
+ * @brief Waits for pending GPU reads and frees the buffer.
+ */
+void imsdl_stream_free(IMSDL_StreamBuffer* stream);
+
+/**
+ * @brief Starts writing the next region.
+ *
+ * Blocks only if the GPU is still reading the region from
+ * IMSDL_STREAM_REGIONS frames ago. If size exceeds the region size, the
+ * buffer is recreated with larger regions after all pending reads finish.
+ * If the larger buffer cannot be allocated, the current buffer is kept and
+ * later frames that fit it still succeed.
+ *
+ * @param stream The stream to write.
+ * @param size The number of bytes the frame will push, including alignment.
+ * @return False if the buffer could not be grown. The frame must then not
+ * push into or end the stream.
+ */
+bool imsdl_stream_begin(IMSDL_StreamBuffer* stream, size_t size);
+
+/**
+ * @brief Copies data into the current region.
+ *
+ * @param alignment The alignment of the returned offset, must be a power of 2.
+ * @return The byte offset of the data within the buffer, or SIZE_MAX if the
+ * region is full.
+ */
+size_t imsdl_stream_push(
+    IMSDL_StreamBuffer* stream, const void* data, size_t size, size_t alignment
+);
+
+/**
+ * @brief Fences the current region after the draws reading it were issued.
+ */
+void imsdl_stream_end(IMSDL_StreamBuffer* stream);
+
+#endif // IMSDL_STREAM_H
@@ -13,15 +13,59 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h>
 
+#include "arena.h"
+#include "capture.h"
+#include "draw.h"
+#include "raster.h"
+#include "stream.h"
+
+// Initial capacity in bytes of each per-frame arena
+#define IMSDL_FRAME_ARENA_SIZE (64 * 1024)
+
+// Explicit uniform location of uProjection in every imsdl shader
+#define IMSDL_UNIFORM_PROJECTION 0
+
 // Viewport Color
 typedef struct IMSDL_Viewport_Color {
     float r, g, b, a;
 } IMSDL_Viewport_Color;
 
+// Marks cached GL state as unknown so the next call is always issued
+#define IMSDL_GL_UNKNOWN 0xFFFFFFFFu
+
+// Number of texture units tracked by the state cache
+#define IMSDL_GL_TEXTURE_UNITS 8
+
+// Viewport GL State: last values passed to GL, used to skip redundant calls
+typedef struct IMSDL_Viewport_State {
+    GLuint framebuffer;
+    GLuint program;
+    GLuint vertex_array;
+    GLuint array_buffer;
+    GLuint element_buffer; // Belongs to vertex_array, unknown after it changes
+    GLenum active_texture;
+    GLuint textures[IMSDL_GL_TEXTURE_UNITS]; // GL_TEXTURE_2D binding per unit
+    GLuint blend; // GL_TRUE, GL_FALSE, or IMSDL_GL_UNKNOWN
+    GLenum blend_src;
+    GLenum blend_dst;
+    GLuint scissor; // GL_TRUE, GL_FALSE, or IMSDL_GL_UNKNOWN
+    GLint scissor_box[4];
+    GLint viewport[4];
+    uint64_t issued; // State changes passed to GL
+    uint64_t elided; // Redundant state changes skipped
+} IMSDL_Viewport_State;
+
 // Viewport OpenGL
 typedef struct IMSDL_Viewport_GL {
-    GLuint vao;
-    GLuint vbo;
+    GLuint vao; // Triangle vertex layout
+    GLuint rect_vao; // Unit quad plus per-instance rect layout
+    GLuint quad_vbo; // Static unit quad shared by every rect instance
+    IMSDL_StreamBuffer* stream; // Per-frame vertices, indices and rect instances
+    GLuint white_texture; // Bound for IMSDL_TEXTURE_NONE
+    GLuint framebuffer; // Offscreen render target in headless mode, 0 for the window
+    GLuint color_buffer; // Color renderbuffer attached to framebuffer
+    IMSDL_Capture* capture; // Pending framebuffer readbacks
+    IMSDL_Viewport_State state;
     SDL_GLContext context;
     int swap_interval;
 } IMSDL_Viewport_GL;
@@ -33,35 +77,95 @@ typedef struct IMSDL_Viewport_View {
     int width;
     int height;
     int flags;
+    bool headless; // Hidden window on the offscreen driver, drawn into gl.framebuffer
 } IMSDL_Viewport_View;
 
+// Viewport Backend
+typedef enum IMSDL_Viewport_Backend {
+    IMSDL_BACKEND_OPENGL, // Draw lists are submitted to GL
+    IMSDL_BACKEND_SOFTWARE // Draw lists are rasterized on the CPU into the window surface
+} IMSDL_Viewport_Backend;
+
+// Viewport Run Mode
+typedef enum IMSDL_Viewport_RunMode {
+    IMSDL_RUN_CONTINUOUS, // Poll events and draw every iteration, for animation and benchmarks
+    IMSDL_RUN_ON_DEMAND // Sleep in SDL until an event, redraw request, or deadline arrives
+} IMSDL_Viewport_RunMode;
+
+// Event callback: returns true if the event changed what is drawn
+typedef bool (*IMSDL_EventHandler)(const SDL_Event* event, void* user_data);
+
 // Viewport Structure
 typedef struct IMSDL_Viewport {
     IMSDL_Viewport_View view;
     IMSDL_Viewport_GL gl;
     IMSDL_Viewport_Color color;
+    FrameArena* frame; // Per-frame scratch memory, swapped by imsdl_render
+    IMSDL_DrawList* draw; // Primitives submitted and cleared by imsdl_render
+    IMSDL_Viewport_Backend backend;
+    IMSDL_Raster* raster; // Software backend only
+    IMSDL_Viewport_RunMode run_mode;
+    bool needs_redraw; // Cleared by imsdl_render
+    uint64_t redraw_deadline; // SDL_GetTicks64 time of the next animation frame, or 0 for none
+    bool capture_requested; // Read back the next frame rendered
 } IMSDL_Viewport;
 
-// Initialize SDL Window and OpenGL Context
-void imsdl_init_sdl_window(IMSDL_Viewport* viewport);
-void imsdl_init_opengl_context(IMSDL_Viewport* viewport);
-void imsdl_init_opengl_vertex_buffer(IMSDL_Viewport* viewport, float* vertices, size_t vertex_size);
+// Initialize SDL Window and OpenGL Context; each logs and returns false on failure
+bool imsdl_init_sdl_window(IMSDL_Viewport* viewport);
+bool imsdl_init_opengl_context(IMSDL_Viewport* viewport);
+bool imsdl_init_opengl_framebuffer(IMSDL_Viewport* viewport);
+bool imsdl_init_opengl_draw_buffers(IMSDL_Viewport* viewport);
 
-// Create and Destroy Viewport
+// Create and Destroy Viewport; create returns NULL on failure
 IMSDL_Viewport* imsdl_create_viewport(const char* title, int width, int height, int flags);
 void imsdl_destroy_viewport(IMSDL_Viewport* viewport);
 
+// Create a viewport without a display, rendering into a width x height framebuffer.
+// Uses SDL's offscreen driver unless SDL_VIDEODRIVER selects another one.
+IMSDL_Viewport* imsdl_create_headless_viewport(const char* title, int width, int height);
+
+// Create a viewport that rasterizes on the CPU, for machines without usable GL.
+// GL functions, shaders and captures are unavailable on it.
+IMSDL_Viewport* imsdl_create_software_viewport(const char* title, int width, int height, int flags);
+
+// Cached GL state changes; call imsdl_gl_invalidate after touching GL state directly
+void imsdl_gl_invalidate(IMSDL_Viewport* viewport);
+void imsdl_gl_bind_framebuffer(IMSDL_Viewport* viewport, GLuint framebuffer);
+void imsdl_gl_use_program(IMSDL_Viewport* viewport, GLuint program);
+void imsdl_gl_bind_vertex_array(IMSDL_Viewport* viewport, GLuint vertex_array);
+void imsdl_gl_bind_buffer(IMSDL_Viewport* viewport, GLenum target, GLuint buffer);
+void imsdl_gl_bind_texture(IMSDL_Viewport* viewport, GLuint unit, GLuint texture);
+void imsdl_gl_blend(IMSDL_Viewport* viewport, bool enabled, GLenum src, GLenum dst);
+void imsdl_gl_scissor(IMSDL_Viewport* viewport, bool enabled, GLint x, GLint y, GLint w, GLint h);
+void imsdl_gl_viewport(IMSDL_Viewport* viewport, GLint x, GLint y, GLint w, GLint h);
+
 // Enable and disable vsync
 void imsdl_toggle_vsync(IMSDL_Viewport* viewport);
 
-// Render Function
-void imsdl_render(IMSDL_Viewport* viewport, GLuint shader_program);
+// Render Function: submits the draw list in window coordinates and clears it.
+// shader_program draws triangles, rect_program draws instanced rounded rects;
+// both are ignored by the software backend.
+void imsdl_render(IMSDL_Viewport* viewport, GLuint shader_program, GLuint rect_program);
+
+// Read back the next rendered frame; fetch it with imsdl_capture_read(viewport->gl.capture, ...)
+void imsdl_request_capture(IMSDL_Viewport* viewport);
+
+// Per-frame allocation, valid until the end of the next frame
+void* imsdl_frame_push(IMSDL_Viewport* viewport, size_t size, size_t alignment);
+
+// Redraw on the next iteration, or once delay_ms from now for animations
+void imsdl_request_redraw(IMSDL_Viewport* viewport);
+void imsdl_request_redraw_in(IMSDL_Viewport* viewport, uint32_t delay_ms);
 
-// Event Handling (Basic)
-void imsdl_handle_events(int* running);
+// Event Handling: waits according to the run mode, drains pending events into
+// handler (may be NULL) and returns true if a frame should be drawn.
+bool imsdl_handle_events(
+    IMSDL_Viewport* viewport, int* running, IMSDL_EventHandler handler, void* user_data
+);
 
 // --- SDL, OpenGL, and Viewport Logging ---
 void imsdl_log_viewport(IMSDL_Viewport* viewport);
+void imsdl_log_gl_state(IMSDL_Viewport* viewport);
 void imsdl_log_sdl_and_opengl(void);
 
 #endif // IMSDL_VIEWPORT_H
@@ -0,0 +1,128 @@
+/**
+ * @file include/watch.h
+ * @brief Shader hot reload for development.
+ *
+ * A worker thread watches a shader directory with inotify and reads every
+ * file that is written or renamed into it. The render thread picks the new
+ * text up in imsdl_shader_watch_poll, rebuilds each program that uses the
+ * file, and replaces the program only once it links. A program that fails
+ * to compile or link is discarded and the old one stays in use.
+ *
+ * With GL_KHR_parallel_shader_compile the driver compiles on its own
+ * threads and the build is polled with GL_COMPLETION_STATUS_KHR, so a
+ * rebuild never stalls a frame. Without it the status is checked one poll
+ * later, which still leaves the driver a frame to finish.
+ */
+
+#ifndef IMSDL_WATCH_H
+#define IMSDL_WATCH_H
+
+#include <GL/glew.h>
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Maximum number of programs that can be watched
+#define IMSDL_SHADER_WATCH_PROGRAMS 16
+
+// Maximum number of changed files held between two polls
+#define IMSDL_SHADER_WATCH_FILES 32
+
+// Longest file name tracked, including the terminator
+#define IMSDL_SHADER_WATCH_NAME_SIZE 64
+
+// Called from the worker thread after files change, e.g. to wake an idle event loop
+typedef void (*IMSDL_ShaderWatchNotify)(void* user_data);
+
+/**
+ * @struct IMSDL_ShaderWatchFile
+ * @brief A changed file read by the worker.
+ */
+typedef struct IMSDL_ShaderWatchFile {
+    char name[IMSDL_SHADER_WATCH_NAME_SIZE];
+    char* text; // NUL-terminated, owned by the watch
+} IMSDL_ShaderWatchFile;
+
+/**
+ * @struct IMSDL_ShaderWatchProgram
+ * @brief A program that is rebuilt when either of its shaders changes.
+ */
+typedef struct IMSDL_ShaderWatchProgram {
+    GLuint* program; // Owner's handle, replaced when a rebuild links
+    const char* vertex_name;
+    const char* fragment_name;
+    GLuint pending; // Program being built, or 0
+    GLuint vertex_shader; // Shaders of the pending program, kept for their logs
+    GLuint fragment_shader;
+} IMSDL_ShaderWatchProgram;
+
+/**
+ * @struct IMSDL_ShaderWatch
+ * @brief The watched directory, its worker thread and the watched programs.
+ */
+typedef struct IMSDL_ShaderWatch {
+    const char* directory;
+    int inotify_fd;
+    int stop_fd; // eventfd written to stop the worker
+    pthread_t thread;
+    bool parallel; // Driver compiles in the background and reports completion
+    IMSDL_ShaderWatchNotify notify;
+    void* user_data;
+
+    // Shared with the worker
+    pthread_mutex_t lock;
+    IMSDL_ShaderWatchFile files[IMSDL_SHADER_WATCH_FILES];
+    size_t file_count;
+
+    // Render thread only
+    IMSDL_ShaderWatchProgram programs[IMSDL_SHADER_WATCH_PROGRAMS];
+    size_t program_count;
+} IMSDL_ShaderWatch;
+
+/**
+ * @brief Starts watching directory for shader changes.
+ *
+ * Requires a current GL context, which every later call also needs.
+ *
+ * @param directory The directory shaders are loaded from, usually IMSDL_SHADER_DIR.
+ * @param notify Optional callback run on the worker thread after files change.
+ * @return A pointer to the watch, or NULL on failure.
+ */
+IMSDL_ShaderWatch* imsdl_shader_watch_create(
+    const char* directory, IMSDL_ShaderWatchNotify notify, void* user_data
+);
+
+/**
+ * @brief Stops the worker and deletes programs still being built.
+ *
+ * Watched programs themselves belong to the caller.
+ */
+void imsdl_shader_watch_free(IMSDL_ShaderWatch* watch);
+
+/**
+ * @brief Rebuilds *program whenever vertex_name or fragment_name changes.
+ *
+ * @param program Where the caller keeps the program; must outlive the watch.
+ * @return False if the watch is full.
+ */
+bool imsdl_shader_watch_add(
+    IMSDL_ShaderWatch* watch, GLuint* program, const char* vertex_name, const char* fragment_name
+);
+
+/**
+ * @brief Starts rebuilds for changed files and swaps in programs that have linked.
+ *
+ * Call once per frame on the render thread, outside of drawing.
+ *
+ * @return True if any watched program was replaced; GL state caches that
+ * track the current program must be invalidated.
+ */
+bool imsdl_shader_watch_poll(IMSDL_ShaderWatch* watch);
+
+/**
+ * @brief Returns true while a rebuild is in progress and needs polling.
+ */
+bool imsdl_shader_watch_busy(const IMSDL_ShaderWatch* watch);
+
+#endif // IMSDL_WATCH_H
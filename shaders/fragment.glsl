@@ -1,6 +1,11 @@
-#version 460 core
+#version 450 core
+in vec2 vUV;
+in vec4 vColor;
+
+layout(binding = 0) uniform sampler2D uTexture; // White 1x1 texture for untextured primitives
+
 out vec4 FragColor;
 
 void main() {
-    FragColor = vec4(1.0, 1.0, 1.0, 1.0); // White color
+    FragColor = vColor * texture(uTexture, vUV);
 }
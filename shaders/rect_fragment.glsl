@@ -0,0 +1,30 @@
+#version 450 core
+in vec2 vLocal;
+flat in vec2 vHalfSize;
+flat in vec2 vShape;
+flat in vec4 vFill;
+flat in vec4 vBorderColor;
+
+out vec4 FragColor;
+
+// Signed distance to a rounded box centered at the origin, negative inside
+float rounded_box(vec2 p, vec2 half_size, float radius) {
+    vec2 q = abs(p) - half_size + radius;
+    return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+void main() {
+    float distance = rounded_box(vLocal, vHalfSize, vShape.x);
+    float aa = max(fwidth(distance), 1e-4);
+
+    // Coverage of the whole box, and of the fill inside the border
+    float outer = clamp(0.5 - distance / aa, 0.0, 1.0);
+    float inner = clamp(0.5 - (distance + vShape.y) / aa, 0.0, 1.0);
+
+    // Blend premultiplied so a transparent fill does not darken the border edge
+    vec4 fill = vec4(vFill.rgb * vFill.a, vFill.a);
+    vec4 border = vec4(vBorderColor.rgb * vBorderColor.a, vBorderColor.a);
+    vec4 color = (vShape.y > 0.0 ? mix(border, fill, inner) : fill) * outer;
+
+    FragColor = vec4(color.rgb / max(color.a, 1e-4), color.a);
+}
@@ -0,0 +1,27 @@
+#version 450 core
+layout(location = 0) in vec2 aCorner; // Unit quad corner in [0, 1]
+layout(location = 1) in vec4 aRect; // Per instance: x0, y0, x1, y1 in pixels
+layout(location = 2) in vec2 aShape; // Per instance: corner radius, border width
+layout(location = 3) in vec4 aFill; // Per instance
+layout(location = 4) in vec4 aBorderColor; // Per instance
+
+layout(location = 0) uniform mat4 uProjection; // Window coordinates to clip space
+
+out vec2 vLocal; // Position relative to the rect center
+flat out vec2 vHalfSize;
+flat out vec2 vShape;
+flat out vec4 vFill;
+flat out vec4 vBorderColor;
+
+void main() {
+    vec2 center = (aRect.xy + aRect.zw) * 0.5;
+    vHalfSize = abs(aRect.zw - aRect.xy) * 0.5;
+
+    // Pad by a pixel so the anti-aliased edge is not clipped
+    vLocal = (aCorner * 2.0 - 1.0) * (vHalfSize + 1.0);
+
+    vShape = vec2(min(aShape.x, min(vHalfSize.x, vHalfSize.y)), aShape.y);
+    vFill = aFill;
+    vBorderColor = aBorderColor;
+    gl_Position = uProjection * vec4(center + vLocal, 0.0, 1.0);
+}
@@ -1,6 +1,15 @@
-#version 460 core
+#version 450 core
 layout(location = 0) in vec2 aPos;
+layout(location = 1) in vec2 aUV;
+layout(location = 2) in vec4 aColor;
+
+layout(location = 0) uniform mat4 uProjection; // Window coordinates to clip space
+
+out vec2 vUV;
+out vec4 vColor;
 
 void main() {
-    gl_Position = vec4(aPos, 0.0, 1.0);
+    vUV = aUV;
+    vColor = aColor;
+    gl_Position = uProjection * vec4(aPos, 0.0, 1.0);
 }
@@ -7,6 +7,8 @@
  */
 
 #include "logger.h"
+#include "memstat.h"
+#include "profile.h"
 #include "align.h"
 
 void* aligned_pointer(void* ptr, size_t alignment) {
@@ -25,7 +27,7 @@ void* aligned_pointer(void* ptr, size_t alignment) {
     return (void*) addr;
 }
 
-void* aligned_malloc(size_t alignment, size_t size) {
+void*(aligned_malloc)(size_t alignment, size_t size) {
     // Ensure alignment is at least sizeof(void*) and a power of 2
     if (alignment < sizeof(void*)) {
         alignment = sizeof(void*);
@@ -35,6 +37,17 @@ void* aligned_malloc(size_t alignment, size_t size) {
         return NULL;
     }
 
+#ifdef IMSDL_MEMSTAT
+    // Prepend a header holding the header and block sizes for aligned_free
+    size_t header = alignment < 2 * sizeof(size_t) ? 2 * sizeof(size_t) : alignment;
+    if (size > SIZE_MAX - header) {
+        LOG_ERROR("Aligned allocation overflows (alignment=%zu, size=%zu).", alignment, size);
+        return NULL;
+    }
+    size_t user_size = size;
+    size += header;
+#endif
+
     void* ptr = NULL;
 #ifdef _WIN32
     ptr = _aligned_malloc(size, alignment);
@@ -51,11 +64,31 @@ void* aligned_malloc(size_t alignment, size_t size) {
     }
 #endif
 
+#ifdef IMSDL_MEMSTAT
+    if (ptr == NULL) {
+        return NULL;
+    }
+    size_t* sizes = (size_t*) ((uint8_t*) ptr + header);
+    sizes[-2] = header;
+    sizes[-1] = user_size;
+    MEMSTAT_ALLOC(&memstat_aligned, user_size);
+    ptr = sizes;
+#endif
+
+    if (ptr) {
+        PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 1);
+    }
     return ptr;
 }
 
 void aligned_free(void* ptr) {
     if (ptr) {
+#ifdef IMSDL_MEMSTAT
+        size_t* sizes = (size_t*) ptr;
+        MEMSTAT_FREE(&memstat_aligned, sizes[-1]);
+        ptr = (uint8_t*) ptr - sizes[-2];
+#endif
+
 #ifdef _WIN32
         _aligned_free(ptr);
 #else
@@ -63,3 +96,182 @@ void aligned_free(void* ptr) {
 #endif
     }
 }
+
+/**
+ * @brief Fault in every page of a block by writing to it.
+ */
+static void aligned_prefault(void* ptr, size_t size) {
+#if defined(MADV_POPULATE_WRITE)
+    // Linux 5.14+: populate in a single call
+    if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+#endif
+    volatile uint8_t* bytes = (volatile uint8_t*) ptr;
+    size_t page_size = virtual_page_size();
+    for (size_t offset = 0; offset < size; offset += page_size) {
+        bytes[offset] = 0;
+    }
+}
+
+void* aligned_malloc_huge(size_t size, bool prefault) {
+    if (size == 0 || size > SIZE_MAX - 2 * ALIGN_HUGE_PAGE_SIZE) {
+        LOG_ERROR("Invalid huge allocation size %zu.", size);
+        return NULL;
+    }
+    size = (size + ALIGN_HUGE_PAGE_SIZE - 1) & ~(ALIGN_HUGE_PAGE_SIZE - 1);
+
+#ifdef _WIN32
+    // Large pages need SeLockMemoryPrivilege; fall back to regular pages
+    void* ptr = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    if (ptr == NULL) {
+        LOG_ERROR("VirtualAlloc failed (size=%zu).", size);
+        return NULL;
+    }
+#else
+    // Over-map so the block can start on a huge page boundary
+    size_t mapped_size = size + ALIGN_HUGE_PAGE_SIZE;
+    uint8_t* mapped = (uint8_t*) mmap(
+        NULL, mapped_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+    );
+    if (mapped == MAP_FAILED) {
+        LOG_ERROR("mmap failed (size=%zu).", mapped_size);
+        return NULL;
+    }
+
+    // Trim the unaligned head and the unused tail
+    uintptr_t addr = (uintptr_t) mapped;
+    uint8_t* ptr = (uint8_t*) ((addr + ALIGN_HUGE_PAGE_SIZE - 1) & ~(ALIGN_HUGE_PAGE_SIZE - 1));
+    size_t head = (size_t) (ptr - mapped);
+    if (head > 0) {
+        munmap(mapped, head);
+    }
+    if (mapped_size - head > size) {
+        munmap(ptr + size, mapped_size - head - size);
+    }
+
+    #ifdef MADV_HUGEPAGE
+    if (madvise(ptr, size, MADV_HUGEPAGE) != 0) {
+        LOG_DEBUG("madvise(MADV_HUGEPAGE) unavailable, using regular pages.");
+    }
+    #endif
+#endif
+
+    if (prefault) {
+        aligned_prefault(ptr, size);
+    }
+
+    MEMSTAT_ALLOC(&memstat_aligned, size);
+    PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 1);
+    return ptr;
+}
+
+void aligned_free_huge(void* ptr, size_t size) {
+    if (ptr) {
+        size = (size + ALIGN_HUGE_PAGE_SIZE - 1) & ~(ALIGN_HUGE_PAGE_SIZE - 1);
+        MEMSTAT_FREE(&memstat_aligned, size);
+#ifdef _WIN32
+        VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+        munmap(ptr, size);
+#endif
+    }
+}
+
+size_t virtual_page_size(void) {
+    static size_t page_size = 0;
+    if (page_size == 0) {
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        page_size = (size_t) info.dwPageSize;
+#else
+        long result = sysconf(_SC_PAGESIZE);
+        page_size = result > 0 ? (size_t) result : 4096;
+#endif
+    }
+    return page_size;
+}
+
+/**
+ * @brief Round size up to a multiple of the page size.
+ */
+static size_t virtual_round_up(size_t size) {
+    size_t page_size = virtual_page_size();
+    return (size + page_size - 1) & ~(page_size - 1);
+}
+
+void* virtual_reserve(size_t size) {
+    size = virtual_round_up(size);
+
+#ifdef _WIN32
+    void* ptr = VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+    if (ptr == NULL) {
+        LOG_ERROR("VirtualAlloc reserve failed (size=%zu).", size);
+    }
+    return ptr;
+#else
+    void* ptr = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR("mmap reserve failed (size=%zu).", size);
+        return NULL;
+    }
+    return ptr;
+#endif
+}
+
+bool virtual_commit(void* ptr, size_t size) {
+    size = virtual_round_up(size);
+
+#ifdef _WIN32
+    if (VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) == NULL) {
+        LOG_ERROR("VirtualAlloc commit failed (size=%zu).", size);
+        return false;
+    }
+#else
+    if (mprotect(ptr, size, PROT_READ | PROT_WRITE) != 0) {
+        LOG_ERROR("mprotect commit failed (size=%zu).", size);
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+void virtual_decommit(void* ptr, size_t size) {
+    size = virtual_round_up(size);
+
+#ifdef _WIN32
+    VirtualFree(ptr, size, MEM_DECOMMIT);
+#else
+    // Remapping drops the pages and restores PROT_NONE in a single call
+    void* result = mmap(
+        ptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0
+    );
+    if (result == MAP_FAILED) {
+        LOG_WARN("mmap decommit failed (size=%zu).", size);
+    }
+#endif
+}
+
+void virtual_release(void* ptr, size_t size) {
+    if (ptr) {
+#ifdef _WIN32
+        (void) size;
+        VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+        munmap(ptr, virtual_round_up(size));
+#endif
+    }
+}
+
+void virtual_advise_huge(void* ptr, size_t size) {
+#if !defined(_WIN32) && defined(MADV_HUGEPAGE)
+    if (madvise(ptr, virtual_round_up(size), MADV_HUGEPAGE) != 0) {
+        LOG_DEBUG("madvise(MADV_HUGEPAGE) unavailable, using regular pages.");
+    }
+#else
+    (void) ptr;
+    (void) size;
+#endif
+}
@@ -6,6 +6,120 @@
 #include "logger.h"
 #include "align.h"
 #include "arena.h"
+#include "profile.h"
+
+#include <pthread.h>
+#include <string.h>
+
+/**
+ * @brief Allocate a block with at least capacity bytes of aligned storage.
+ */
+static ArenaBlock* arena_block_create(size_t capacity, size_t alignment) {
+    ArenaBlock* block = (ArenaBlock*) malloc(sizeof(ArenaBlock));
+    if (block == NULL) {
+        LOG_ERROR("Failed to allocate memory for ArenaBlock.");
+        return NULL;
+    }
+
+    block->data = (uint8_t*) aligned_malloc(alignment, capacity);
+    if (block->data == NULL) {
+        LOG_ERROR("Failed to allocate memory for ArenaBlock data.");
+        free(block);
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->capacity = capacity;
+    block->committed = capacity;
+    block->offset = 0;
+
+    return block;
+}
+
+/**
+ * @brief Reserve a block of address space without committing it.
+ */
+static ArenaBlock* arena_block_reserve(size_t capacity) {
+    ArenaBlock* block = (ArenaBlock*) malloc(sizeof(ArenaBlock));
+    if (block == NULL) {
+        LOG_ERROR("Failed to allocate memory for ArenaBlock.");
+        return NULL;
+    }
+
+    // Round up so the whole reservation is usable
+    size_t page_size = virtual_page_size();
+    capacity = (capacity + page_size - 1) & ~(page_size - 1);
+
+    block->data = (uint8_t*) virtual_reserve(capacity);
+    if (block->data == NULL) {
+        LOG_ERROR("Failed to reserve address space for ArenaBlock data.");
+        free(block);
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->capacity = capacity;
+    block->committed = 0;
+    block->offset = 0;
+
+    return block;
+}
+
+/**
+ * @brief Free a block and its data.
+ */
+static void arena_block_free(const Arena* arena, ArenaBlock* block) {
+    if (arena->flags & ARENA_FLAG_VIRTUAL) {
+        virtual_release(block->data, block->capacity);
+    } else {
+        aligned_free(block->data);
+    }
+    free(block);
+}
+
+/**
+ * @brief Commit pages in a reserved block until at least end bytes are usable.
+ */
+static bool arena_block_commit(ArenaBlock* block, size_t end) {
+    if (end > block->capacity) {
+        return false;
+    }
+
+    size_t committed = (end + ARENA_COMMIT_SIZE - 1) & ~(size_t) (ARENA_COMMIT_SIZE - 1);
+    if (committed > block->capacity) {
+        committed = block->capacity;
+    }
+
+    if (!virtual_commit(block->data + block->committed, committed - block->committed)) {
+        return false;
+    }
+
+    block->committed = committed;
+    return true;
+}
+
+/**
+ * @brief Try to bump-allocate from a single block.
+ * @return The aligned pointer, or NULL if the block does not have enough room.
+ */
+static void* arena_block_push(
+    const Arena* arena, ArenaBlock* block, size_t size, size_t alignment
+) {
+    uintptr_t base = (uintptr_t) block->data;
+    uintptr_t addr = (base + block->offset + (alignment - 1)) & ~(uintptr_t) (alignment - 1);
+    size_t start = (size_t) (addr - base);
+
+    if (start > block->committed || size > block->committed - start) {
+        // Only virtual blocks can grow in place
+        if (!(arena->flags & ARENA_FLAG_VIRTUAL) || start > block->capacity
+            || size > block->capacity - start || !arena_block_commit(block, start + size)) {
+            return NULL;
+        }
+    }
+
+    block->offset = start + size;
+    return (void*) addr;
+}
 
 Arena* arena_create(size_t initial_capacity, size_t element_size, size_t alignment) {
     // Ensure valid input
@@ -17,6 +131,23 @@ Arena* arena_create(size_t initial_capacity, size_t element_size, size_t alignme
         LOG_ERROR("Invalid element size, must be greater than 0.");
         return NULL;
     }
+    if (initial_capacity > SIZE_MAX / element_size) {
+        LOG_ERROR(
+            "Arena capacity overflows (capacity=%zu, element_size=%zu).",
+            initial_capacity,
+            element_size
+        );
+        return NULL;
+    }
+
+    // Ensure alignment is at least sizeof(void*) and a power of 2
+    if (alignment < sizeof(void*)) {
+        alignment = sizeof(void*);
+    }
+    if ((alignment & (alignment - 1)) != 0) {
+        LOG_ERROR("Alignment %zu is not a power of 2.", alignment);
+        return NULL;
+    }
 
     // Allocate memory for the arena structure
     Arena* arena = (Arena*) malloc(sizeof(Arena));
@@ -25,26 +156,331 @@ Arena* arena_create(size_t initial_capacity, size_t element_size, size_t alignme
         return NULL;
     }
 
-    // Allocate memory for the data array with alignment
-    arena->data = aligned_malloc(alignment, initial_capacity * element_size);
-    if (arena->data == NULL) {
+    // Allocate the first block with alignment
+    arena->head = arena_block_create(initial_capacity * element_size, alignment);
+    if (arena->head == NULL) {
         LOG_ERROR("Failed to allocate memory for Arena data.");
         free(arena);
         return NULL;
     }
 
     // Initialize arena fields
-    arena->size = 0;
-    arena->capacity = initial_capacity;
+    arena->current = arena->head;
+    arena->element_size = element_size;
+    arena->alignment = alignment;
+    arena->block_size = initial_capacity * element_size;
+    arena->flags = ARENA_FLAG_NONE;
+    MEMSTAT_REGISTER(&arena->stat, "arena");
+
+    return arena;
+}
+
+Arena* arena_create_virtual(
+    size_t max_capacity, size_t element_size, size_t alignment, unsigned flags
+) {
+    // Ensure valid input
+    if (max_capacity == 0) {
+        LOG_ERROR("Invalid max capacity, must be greater than 0.");
+        return NULL;
+    }
+    if (element_size == 0) {
+        LOG_ERROR("Invalid element size, must be greater than 0.");
+        return NULL;
+    }
+    if (max_capacity > SIZE_MAX / element_size) {
+        LOG_ERROR(
+            "Arena capacity overflows (capacity=%zu, element_size=%zu).",
+            max_capacity,
+            element_size
+        );
+        return NULL;
+    }
+
+    // Ensure alignment is at least sizeof(void*) and a power of 2
+    if (alignment < sizeof(void*)) {
+        alignment = sizeof(void*);
+    }
+    if ((alignment & (alignment - 1)) != 0) {
+        LOG_ERROR("Alignment %zu is not a power of 2.", alignment);
+        return NULL;
+    }
+
+    // Allocate memory for the arena structure
+    Arena* arena = (Arena*) malloc(sizeof(Arena));
+    if (arena == NULL) {
+        LOG_ERROR("Failed to allocate memory for Arena.");
+        return NULL;
+    }
+
+    // Reserve the whole capacity; pages are committed by arena_push
+    arena->head = arena_block_reserve(max_capacity * element_size);
+    if (arena->head == NULL) {
+        LOG_ERROR("Failed to reserve memory for Arena data.");
+        free(arena);
+        return NULL;
+    }
+
+    // Initialize arena fields
+    arena->current = arena->head;
     arena->element_size = element_size;
     arena->alignment = alignment;
+    arena->block_size = arena->head->capacity;
+    arena->flags = ARENA_FLAG_VIRTUAL | (flags & (ARENA_FLAG_DECOMMIT | ARENA_FLAG_HUGE_PAGES));
+
+    // Huge pages cut TLB misses when large arenas are walked every frame
+    if (arena->flags & ARENA_FLAG_HUGE_PAGES) {
+        virtual_advise_huge(arena->head->data, arena->head->capacity);
+    }
+    MEMSTAT_REGISTER(&arena->stat, "virtual arena");
 
     return arena;
 }
 
 void arena_free(Arena* arena) {
     if (arena) {
-        free(arena->data); // Free the aligned data
+        MEMSTAT_UNREGISTER(&arena->stat);
+        ArenaBlock* block = arena->head;
+        while (block) {
+            ArenaBlock* next = block->next;
+            arena_block_free(arena, block); // Free the aligned data
+            block = next;
+        }
         free(arena); // Free the arena structure itself
     }
 }
+
+/**
+ * @brief Find or chain a block with room for size bytes at alignment.
+ */
+static void* arena_push_block(Arena* arena, size_t size, size_t alignment) {
+    // Fast path: bump within the current block
+    ArenaBlock* block = arena->current;
+    void* ptr = arena_block_push(arena, block, size, alignment);
+    if (ptr) {
+        return ptr;
+    }
+
+    // Virtual arenas never chain so their pointers and data stay contiguous
+    if (arena->flags & ARENA_FLAG_VIRTUAL) {
+        LOG_ERROR(
+            "Virtual arena exhausted (size=%zu, used=%zu, capacity=%zu).",
+            size,
+            block->offset,
+            block->capacity
+        );
+        return NULL;
+    }
+
+    // Reuse blocks released by a previous reset or restore
+    while (block->next) {
+        block = block->next;
+        block->offset = 0;
+        ptr = arena_block_push(arena, block, size, alignment);
+        if (ptr) {
+            arena->current = block;
+            return ptr;
+        }
+    }
+
+    // Chain a new block large enough for the request
+    if (size > SIZE_MAX - alignment) {
+        LOG_ERROR("Arena push overflows (size=%zu, alignment=%zu).", size, alignment);
+        return NULL;
+    }
+    size_t capacity = size + alignment;
+    if (capacity < arena->block_size) {
+        capacity = arena->block_size;
+    }
+
+    ArenaBlock* chained = arena_block_create(capacity, arena->alignment);
+    if (chained == NULL) {
+        return NULL;
+    }
+    block->next = chained;
+    arena->current = chained;
+
+    return arena_block_push(arena, chained, size, alignment);
+}
+
+void*(arena_push)(Arena* arena, size_t size, size_t alignment) {
+    if (alignment == 0) {
+        alignment = arena->alignment;
+    }
+    if ((alignment & (alignment - 1)) != 0) {
+        LOG_ERROR("Alignment %zu is not a power of 2.", alignment);
+        return NULL;
+    }
+
+    void* ptr = arena_push_block(arena, size, alignment);
+    if (ptr) {
+        MEMSTAT_ALLOC(&arena->stat, size);
+        PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 1);
+    }
+    return ptr;
+}
+
+void*(arena_push_zero)(Arena* arena, size_t size, size_t alignment) {
+    void* ptr = (arena_push)(arena, size, alignment);
+    if (ptr) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void*(arena_push_array)(Arena* arena, size_t count) {
+    if (count > SIZE_MAX / arena->element_size) {
+        LOG_ERROR(
+            "Arena array overflows (count=%zu, element_size=%zu).", count, arena->element_size
+        );
+        return NULL;
+    }
+    return (arena_push)(arena, count * arena->element_size, arena->alignment);
+}
+
+ArenaMark arena_mark(const Arena* arena) {
+    return (ArenaMark) {arena->current, arena->current->offset};
+}
+
+void arena_restore(Arena* arena, ArenaMark mark) {
+    arena->current = mark.block;
+    arena->current->offset = mark.offset;
+    MEMSTAT_SET_LIVE(&arena->stat, arena_used(arena));
+}
+
+void arena_reset(Arena* arena) {
+    arena->current = arena->head;
+    arena->current->offset = 0;
+    MEMSTAT_SET_LIVE(&arena->stat, 0);
+
+    // Keep the first commit step resident so the next frame does not fault
+    ArenaBlock* block = arena->head;
+    if ((arena->flags & ARENA_FLAG_DECOMMIT) && block->committed > ARENA_COMMIT_SIZE) {
+        uint8_t* start = block->data + ARENA_COMMIT_SIZE;
+        size_t size = block->committed - ARENA_COMMIT_SIZE;
+        virtual_decommit(start, size);
+        // The decommitted range is a fresh mapping that has lost its advice
+        if (arena->flags & ARENA_FLAG_HUGE_PAGES) {
+            virtual_advise_huge(start, size);
+        }
+        block->committed = ARENA_COMMIT_SIZE;
+    }
+}
+
+size_t arena_used(const Arena* arena) {
+    size_t used = 0;
+    for (ArenaBlock* block = arena->head; block != arena->current; block = block->next) {
+        used += block->offset;
+    }
+    return used + arena->current->offset;
+}
+
+FrameArena* frame_arena_create(size_t capacity, size_t alignment) {
+    FrameArena* frame_arena = (FrameArena*) malloc(sizeof(FrameArena));
+    if (frame_arena == NULL) {
+        LOG_ERROR("Failed to allocate memory for FrameArena.");
+        return NULL;
+    }
+
+    frame_arena->frame = 0;
+    for (size_t i = 0; i < 2; i++) {
+        frame_arena->arenas[i] = arena_create(capacity, 1, alignment);
+        if (frame_arena->arenas[i] == NULL) {
+            LOG_ERROR("Failed to create FrameArena arena %zu.", i);
+            arena_free(frame_arena->arenas[0]);
+            free(frame_arena);
+            return NULL;
+        }
+        frame_arena->arenas[i]->stat.name = "frame arena";
+    }
+
+    return frame_arena;
+}
+
+void frame_arena_free(FrameArena* frame_arena) {
+    if (frame_arena) {
+        arena_free(frame_arena->arenas[0]);
+        arena_free(frame_arena->arenas[1]);
+        free(frame_arena);
+    }
+}
+
+Arena* frame_arena_current(FrameArena* frame_arena) {
+    return frame_arena->arenas[frame_arena->frame & 1];
+}
+
+Arena* frame_arena_previous(FrameArena* frame_arena) {
+    return frame_arena->arenas[(frame_arena->frame + 1) & 1];
+}
+
+void frame_arena_swap(FrameArena* frame_arena) {
+    frame_arena->frame++;
+    arena_reset(frame_arena_current(frame_arena));
+}
+
+// Per-thread scratch arenas, created on first use
+static _Thread_local Arena* arena_scratch[ARENA_SCRATCH_COUNT];
+
+// Key whose destructor frees a worker thread's scratch arenas on exit
+static pthread_key_t arena_scratch_key;
+static pthread_once_t arena_scratch_once = PTHREAD_ONCE_INIT;
+
+/**
+ * @brief Free the scratch arenas registered for an exiting thread.
+ */
+static void arena_scratch_destroy(void* value) {
+    Arena** scratch = (Arena**) value;
+    for (size_t i = 0; i < ARENA_SCRATCH_COUNT; i++) {
+        arena_free(scratch[i]);
+        scratch[i] = NULL;
+    }
+}
+
+static void arena_scratch_init_key(void) {
+    if (pthread_key_create(&arena_scratch_key, arena_scratch_destroy) != 0) {
+        LOG_WARN("Failed to create scratch arena key; worker scratch arenas will leak.");
+    }
+}
+
+ArenaScratch arena_scratch_begin(Arena* const* conflicts, size_t conflict_count) {
+    for (size_t i = 0; i < ARENA_SCRATCH_COUNT; i++) {
+        // Lazily create the arena the first time this thread needs it
+        if (arena_scratch[i] == NULL) {
+            pthread_once(&arena_scratch_once, arena_scratch_init_key);
+            arena_scratch[i] = arena_create_virtual(ARENA_SCRATCH_SIZE, 1, 0, ARENA_FLAG_NONE);
+            if (arena_scratch[i] == NULL) {
+                LOG_ERROR("Failed to create scratch arena %zu.", i);
+                break;
+            }
+            arena_scratch[i]->stat.name = "scratch arena";
+            pthread_setspecific(arena_scratch_key, arena_scratch);
+        }
+
+        // Skip arenas the caller is already using
+        bool conflicting = false;
+        for (size_t j = 0; j < conflict_count; j++) {
+            if (conflicts[j] == arena_scratch[i]) {
+                conflicting = true;
+                break;
+            }
+        }
+
+        if (!conflicting) {
+            return (ArenaScratch) {arena_scratch[i], arena_mark(arena_scratch[i])};
+        }
+    }
+
+    LOG_ERROR("No scratch arena available (conflicts=%zu).", conflict_count);
+    return (ArenaScratch) {NULL, {NULL, 0}};
+}
+
+void arena_scratch_end(ArenaScratch scratch) {
+    if (scratch.arena) {
+        arena_restore(scratch.arena, scratch.mark);
+    }
+}
+
+void arena_scratch_release(void) {
+    arena_scratch_destroy(arena_scratch);
+    pthread_once(&arena_scratch_once, arena_scratch_init_key);
+    pthread_setspecific(arena_scratch_key, NULL);
+}
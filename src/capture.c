@@ -0,0 +1,188 @@
+/**
+ * @file src/capture.c
+ * @brief Asynchronous framebuffer readback.
+ */
+
+#include "capture.h"
+#include "logger.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// How long a single fence wait may block before it is retried, in nanoseconds
+#define IMSDL_CAPTURE_WAIT_TIMEOUT 1000000000ull
+
+/**
+ * @brief Returns true once the slot's pixels have landed, optionally waiting.
+ */
+static bool imsdl_capture_ready(IMSDL_CaptureSlot* slot, bool wait) {
+    for (;;) {
+        GLenum result = glClientWaitSync(
+            slot->fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? IMSDL_CAPTURE_WAIT_TIMEOUT : 0
+        );
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            return true;
+        }
+        if (result == GL_WAIT_FAILED) {
+            LOG_ERROR("Capture fence wait failed.");
+            return true; // Reading now is no worse than never releasing the slot
+        }
+        if (!wait) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Drops the oldest pending capture.
+ */
+static void imsdl_capture_pop(IMSDL_Capture* capture) {
+    IMSDL_CaptureSlot* slot = &capture->slots[capture->head];
+    glDeleteSync(slot->fence);
+    slot->fence = NULL;
+    capture->head = (capture->head + 1) % IMSDL_CAPTURE_BUFFERS;
+    capture->count--;
+}
+
+IMSDL_Capture* imsdl_capture_create(void) {
+    IMSDL_Capture* capture = (IMSDL_Capture*) calloc(1, sizeof(IMSDL_Capture));
+    if (!capture) {
+        LOG_ERROR("Failed to allocate memory for capture queue.");
+        return NULL;
+    }
+    return capture;
+}
+
+void imsdl_capture_free(IMSDL_Capture* capture) {
+    if (capture) {
+        while (capture->count > 0) {
+            imsdl_capture_ready(&capture->slots[capture->head], true);
+            imsdl_capture_pop(capture);
+        }
+        for (uint32_t i = 0; i < IMSDL_CAPTURE_BUFFERS; i++) {
+            if (capture->slots[i].buffer) {
+                glDeleteBuffers(1, &capture->slots[i].buffer);
+            }
+        }
+        free(capture);
+    }
+}
+
+bool imsdl_capture_queue(IMSDL_Capture* capture, int width, int height) {
+    if (capture->count == IMSDL_CAPTURE_BUFFERS) {
+        LOG_WARN("Capture queue full, frame not captured.");
+        return false;
+    }
+
+    uint32_t index = (capture->head + capture->count) % IMSDL_CAPTURE_BUFFERS;
+    IMSDL_CaptureSlot* slot = &capture->slots[index];
+    size_t size = (size_t) width * (size_t) height * 4;
+
+    if (!slot->buffer) {
+        glGenBuffers(1, &slot->buffer);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+    if (size > slot->capacity) {
+        // Clear stale errors so only a failure of this allocation is seen below
+        while (glGetError() != GL_NO_ERROR) {}
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr) size, NULL, GL_STREAM_READ);
+        if (glGetError() == GL_OUT_OF_MEMORY) {
+            // The old storage is gone too, so the next capture must reallocate
+            LOG_ERROR("Failed to allocate capture buffer (size=%zu).", size);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            slot->capacity = 0;
+            return false;
+        }
+        slot->capacity = size;
+    }
+
+    // With a pack buffer bound the last argument is an offset, so this returns at once
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void*) 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot->width = width;
+    slot->height = height;
+    capture->count++;
+    return true;
+}
+
+bool imsdl_capture_read(
+    IMSDL_Capture* capture, uint8_t* pixels, size_t size, int* width, int* height, bool wait
+) {
+    if (capture->count == 0) {
+        return false;
+    }
+
+    IMSDL_CaptureSlot* slot = &capture->slots[capture->head];
+    size_t row_size = (size_t) slot->width * 4;
+    size_t frame_size = row_size * (size_t) slot->height;
+    if (size < frame_size) {
+        LOG_ERROR("Capture needs %zu bytes, got %zu.", frame_size, size);
+        return false;
+    }
+    if (!imsdl_capture_ready(slot, wait)) {
+        return false;
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->buffer);
+    const uint8_t* mapped = (const uint8_t*) glMapBufferRange(
+        GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr) frame_size, GL_MAP_READ_BIT
+    );
+    if (!mapped) {
+        LOG_ERROR("Failed to map capture buffer (size=%zu).", frame_size);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        imsdl_capture_pop(capture);
+        return false;
+    }
+
+    // GL rows start at the bottom of the image
+    for (int y = 0; y < slot->height; y++) {
+        const uint8_t* row = mapped + (size_t) (slot->height - 1 - y) * row_size;
+        memcpy(pixels + (size_t) y * row_size, row, row_size);
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    *width = slot->width;
+    *height = slot->height;
+    imsdl_capture_pop(capture);
+    return true;
+}
+
+bool imsdl_capture_write_ppm(const char* path, const uint8_t* pixels, int width, int height) {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        LOG_ERROR("Failed to open capture file: %s", path);
+        return false;
+    }
+
+    fprintf(file, "P6\n%d %d\n255\n", width, height);
+
+    // Strip alpha one row at a time so a large frame needs no second full copy
+    uint8_t* row = (uint8_t*) malloc((size_t) width * 3);
+    if (!row) {
+        LOG_ERROR("Failed to allocate memory for capture row.");
+        fclose(file);
+        return false;
+    }
+
+    bool ok = true;
+    for (int y = 0; y < height && ok; y++) {
+        const uint8_t* source = pixels + (size_t) y * (size_t) width * 4;
+        for (int x = 0; x < width; x++) {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        ok = fwrite(row, 3, (size_t) width, file) == (size_t) width;
+    }
+
+    free(row);
+    if (fclose(file) != 0 || !ok) {
+        LOG_ERROR("Failed to write capture file: %s", path);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,349 @@
+/**
+ * @file src/draw.c
+ * @brief Immediate-mode draw list.
+ */
+
+#include "logger.h"
+#include "draw.h"
+
+#include <math.h>
+
+// Minimum time between two "draw list full" warnings
+#define IMSDL_DRAW_FULL_LOG_INTERVAL_MS 1000
+
+IMSDL_DrawList* imsdl_draw_list_create(size_t max_vertices) {
+    if (max_vertices == 0) {
+        max_vertices = IMSDL_DRAW_MAX_VERTICES;
+    }
+    if (max_vertices > UINT32_MAX / 2) {
+        LOG_ERROR("Draw list capacity %zu exceeds 32-bit indices.", max_vertices);
+        return NULL;
+    }
+
+    IMSDL_DrawList* list = (IMSDL_DrawList*) malloc(sizeof(IMSDL_DrawList));
+    if (!list) {
+        LOG_ERROR("Failed to allocate memory for draw list.");
+        return NULL;
+    }
+
+    // Quads need the most indices per vertex; at worst every primitive is its own command
+    list->max_vertices = (uint32_t) max_vertices;
+    list->max_indices = list->max_vertices / 2 * 3;
+    list->max_rects = list->max_vertices / 4;
+    list->max_commands = list->max_vertices / 3 + list->max_rects + 1;
+
+    list->vertices = arena_create_virtual(
+        list->max_vertices, sizeof(IMSDL_Vertex), _Alignof(IMSDL_Vertex), ARENA_FLAG_NONE
+    );
+    list->indices = arena_create_virtual(
+        list->max_indices, sizeof(IMSDL_Index), _Alignof(IMSDL_Index), ARENA_FLAG_NONE
+    );
+    list->rects = arena_create_virtual(
+        list->max_rects,
+        sizeof(IMSDL_RectInstance),
+        _Alignof(IMSDL_RectInstance),
+        ARENA_FLAG_NONE
+    );
+    list->commands = arena_create_virtual(
+        list->max_commands,
+        sizeof(IMSDL_DrawCommand),
+        _Alignof(IMSDL_DrawCommand),
+        ARENA_FLAG_NONE
+    );
+    if (!list->vertices || !list->indices || !list->rects || !list->commands) {
+        LOG_ERROR("Failed to reserve memory for draw list.");
+        imsdl_draw_list_free(list);
+        return NULL;
+    }
+
+    list->vertex_count = 0;
+    list->index_count = 0;
+    list->rect_count = 0;
+    list->command_count = 0;
+    return list;
+}
+
+void imsdl_draw_list_free(IMSDL_DrawList* list) {
+    if (list) {
+        if (list->vertices) {
+            arena_free(list->vertices);
+        }
+        if (list->indices) {
+            arena_free(list->indices);
+        }
+        if (list->rects) {
+            arena_free(list->rects);
+        }
+        if (list->commands) {
+            arena_free(list->commands);
+        }
+        free(list);
+    }
+}
+
+void imsdl_draw_list_reset(IMSDL_DrawList* list) {
+    arena_reset(list->vertices);
+    arena_reset(list->indices);
+    arena_reset(list->rects);
+    arena_reset(list->commands);
+    list->vertex_count = 0;
+    list->index_count = 0;
+    list->rect_count = 0;
+    list->command_count = 0;
+}
+
+const IMSDL_Vertex* imsdl_draw_list_vertices(const IMSDL_DrawList* list) {
+    return (const IMSDL_Vertex*) list->vertices->head->data;
+}
+
+const IMSDL_Index* imsdl_draw_list_indices(const IMSDL_DrawList* list) {
+    return (const IMSDL_Index*) list->indices->head->data;
+}
+
+const IMSDL_RectInstance* imsdl_draw_list_rects(const IMSDL_DrawList* list) {
+    return (const IMSDL_RectInstance*) list->rects->head->data;
+}
+
+const IMSDL_DrawCommand* imsdl_draw_list_commands(const IMSDL_DrawList* list) {
+    return (const IMSDL_DrawCommand*) list->commands->head->data;
+}
+
+/**
+ * @brief Returns the last command if a primitive of this kind and texture can
+ * extend it, or NULL if it needs a new one.
+ */
+static IMSDL_DrawCommand* imsdl_draw_mergeable(
+    IMSDL_DrawList* list, IMSDL_DrawKind kind, uint32_t texture
+) {
+    if (list->command_count == 0) {
+        return NULL;
+    }
+
+    IMSDL_DrawCommand* command
+        = (IMSDL_DrawCommand*) list->commands->head->data + list->command_count - 1;
+    if (command->kind != kind || command->texture != texture) {
+        return NULL;
+    }
+    return command;
+}
+
+/**
+ * @brief Appends a new command starting at offset.
+ */
+static IMSDL_DrawCommand* imsdl_draw_command_push(
+    IMSDL_DrawList* list, IMSDL_DrawKind kind, uint32_t texture, uint32_t offset
+) {
+    // Push at the element alignment; the arena default would pad between commands
+    IMSDL_DrawCommand* command = (IMSDL_DrawCommand*) arena_push(
+        list->commands, sizeof(IMSDL_DrawCommand), _Alignof(IMSDL_DrawCommand)
+    );
+    if (!command) {
+        return NULL;
+    }
+
+    command->kind = kind;
+    command->texture = texture;
+    command->offset = offset;
+    command->count = 0;
+    list->command_count++;
+    return command;
+}
+
+uint32_t imsdl_draw_reserve(
+    IMSDL_DrawList* list,
+    uint32_t texture,
+    uint32_t vertex_count,
+    uint32_t index_count,
+    IMSDL_Vertex** vertices,
+    IMSDL_Index** indices
+) {
+    IMSDL_DrawCommand* command = imsdl_draw_mergeable(list, IMSDL_DRAW_TRIANGLES, texture);
+
+    // Check up front so a full list drops primitives instead of failing pushes
+    if (vertex_count > list->max_vertices - list->vertex_count
+        || index_count > list->max_indices - list->index_count
+        || (!command && list->command_count == list->max_commands)) {
+        LOG_WARN_RATELIMIT(
+            IMSDL_DRAW_FULL_LOG_INTERVAL_MS,
+            "Draw list full (vertices=%u, indices=%u, commands=%u).",
+            list->vertex_count,
+            list->index_count,
+            list->command_count
+        );
+        return UINT32_MAX;
+    }
+
+    // A failed push unwinds the others so the arenas stay in step with the counts;
+    // the command is pushed last, so it never needs unwinding
+    ArenaMark vertex_mark = arena_mark(list->vertices);
+    ArenaMark index_mark = arena_mark(list->indices);
+
+    // Push at the element alignment; the arena default would pad between primitives
+    *vertices = (IMSDL_Vertex*) arena_push(
+        list->vertices, vertex_count * sizeof(IMSDL_Vertex), _Alignof(IMSDL_Vertex)
+    );
+    *indices = (IMSDL_Index*) arena_push(
+        list->indices, index_count * sizeof(IMSDL_Index), _Alignof(IMSDL_Index)
+    );
+
+    // Start a new command when the kind or texture changes
+    if (*vertices && *indices && !command) {
+        command = imsdl_draw_command_push(list, IMSDL_DRAW_TRIANGLES, texture, list->index_count);
+    }
+    if (!*vertices || !*indices || !command) {
+        arena_restore(list->vertices, vertex_mark);
+        arena_restore(list->indices, index_mark);
+        return UINT32_MAX;
+    }
+    command->count += index_count;
+
+    uint32_t base = list->vertex_count;
+    list->vertex_count += vertex_count;
+    list->index_count += index_count;
+    return base;
+}
+
+/**
+ * @brief Appends a quad from four corners in winding order.
+ */
+static void imsdl_draw_quad(
+    IMSDL_DrawList* list,
+    uint32_t texture,
+    const IMSDL_Vec2 position[4],
+    const IMSDL_Vec2 uv[4],
+    uint32_t color
+) {
+    IMSDL_Vertex* vertices;
+    IMSDL_Index* indices;
+    uint32_t base = imsdl_draw_reserve(list, texture, 4, 6, &vertices, &indices);
+    if (base == UINT32_MAX) {
+        return;
+    }
+
+    for (int i = 0; i < 4; i++) {
+        vertices[i] = (IMSDL_Vertex) {position[i].x, position[i].y, uv[i].x, uv[i].y, color};
+    }
+
+    indices[0] = base;
+    indices[1] = base + 1;
+    indices[2] = base + 2;
+    indices[3] = base;
+    indices[4] = base + 2;
+    indices[5] = base + 3;
+}
+
+void imsdl_draw_rounded_rect(
+    IMSDL_DrawList* list,
+    IMSDL_Vec2 min,
+    IMSDL_Vec2 max,
+    float radius,
+    uint32_t fill,
+    float border,
+    uint32_t border_color
+) {
+    IMSDL_DrawCommand* command = imsdl_draw_mergeable(list, IMSDL_DRAW_RECTS, IMSDL_TEXTURE_NONE);
+    if (list->rect_count == list->max_rects
+        || (!command && list->command_count == list->max_commands)) {
+        LOG_WARN_RATELIMIT(
+            IMSDL_DRAW_FULL_LOG_INTERVAL_MS,
+            "Draw list full (rects=%u, commands=%u).",
+            list->rect_count,
+            list->command_count
+        );
+        return;
+    }
+
+    ArenaMark rect_mark = arena_mark(list->rects);
+    IMSDL_RectInstance* rect = (IMSDL_RectInstance*) arena_push(
+        list->rects, sizeof(IMSDL_RectInstance), _Alignof(IMSDL_RectInstance)
+    );
+    if (rect && !command) {
+        command = imsdl_draw_command_push(
+            list, IMSDL_DRAW_RECTS, IMSDL_TEXTURE_NONE, list->rect_count
+        );
+    }
+    if (!rect || !command) {
+        arena_restore(list->rects, rect_mark); // Keep the arena in step with rect_count
+        return;
+    }
+
+    *rect = (IMSDL_RectInstance) {min.x, min.y, max.x, max.y, radius, border, fill, border_color};
+    command->count++;
+    list->rect_count++;
+}
+
+void imsdl_draw_rect_filled(IMSDL_DrawList* list, IMSDL_Vec2 min, IMSDL_Vec2 max, uint32_t color) {
+    imsdl_draw_rounded_rect(list, min, max, 0.0f, color, 0.0f, 0);
+}
+
+void imsdl_draw_rect(
+    IMSDL_DrawList* list, IMSDL_Vec2 min, IMSDL_Vec2 max, uint32_t color, float thickness
+) {
+    imsdl_draw_rounded_rect(list, min, max, 0.0f, 0, thickness, color);
+}
+
+void imsdl_draw_line(
+    IMSDL_DrawList* list, IMSDL_Vec2 a, IMSDL_Vec2 b, uint32_t color, float thickness
+) {
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float length = sqrtf(dx * dx + dy * dy);
+    if (length <= 0.0f) {
+        return;
+    }
+
+    // Offset both ends by half the thickness along the normal
+    float nx = -dy / length * thickness * 0.5f;
+    float ny = dx / length * thickness * 0.5f;
+    const IMSDL_Vec2 position[4] = {
+        {a.x + nx, a.y + ny},
+        {b.x + nx, b.y + ny},
+        {b.x - nx, b.y - ny},
+        {a.x - nx, a.y - ny},
+    };
+    const IMSDL_Vec2 uv[4] = {{0, 0}, {1, 0}, {1, 1}, {0, 1}};
+    imsdl_draw_quad(list, IMSDL_TEXTURE_NONE, position, uv, color);
+}
+
+void imsdl_draw_triangle_filled(
+    IMSDL_DrawList* list, IMSDL_Vec2 a, IMSDL_Vec2 b, IMSDL_Vec2 c, uint32_t color
+) {
+    IMSDL_Vertex* vertices;
+    IMSDL_Index* indices;
+    uint32_t base = imsdl_draw_reserve(list, IMSDL_TEXTURE_NONE, 3, 3, &vertices, &indices);
+    if (base == UINT32_MAX) {
+        return;
+    }
+
+    vertices[0] = (IMSDL_Vertex) {a.x, a.y, 0.0f, 0.0f, color};
+    vertices[1] = (IMSDL_Vertex) {b.x, b.y, 0.0f, 0.0f, color};
+    vertices[2] = (IMSDL_Vertex) {c.x, c.y, 0.0f, 0.0f, color};
+
+    indices[0] = base;
+    indices[1] = base + 1;
+    indices[2] = base + 2;
+}
+
+void imsdl_draw_image(
+    IMSDL_DrawList* list,
+    uint32_t texture,
+    IMSDL_Vec2 min,
+    IMSDL_Vec2 max,
+    IMSDL_Vec2 uv_min,
+    IMSDL_Vec2 uv_max,
+    uint32_t color
+) {
+    const IMSDL_Vec2 position[4] = {
+        {min.x, min.y},
+        {max.x, min.y},
+        {max.x, max.y},
+        {min.x, max.y},
+    };
+    const IMSDL_Vec2 uv[4] = {
+        {uv_min.x, uv_min.y},
+        {uv_max.x, uv_min.y},
+        {uv_max.x, uv_max.y},
+        {uv_min.x, uv_max.y},
+    };
+    imsdl_draw_quad(list, texture, position, uv, color);
+}
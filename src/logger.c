@@ -13,7 +13,403 @@
 
 #include "logger.h"
 
-const char* LOG_TYPE_NAME[] = {"unknown", "stream", "file"};
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+const char* LOG_TYPE_NAME[] = {"unknown", "stream", "file", "binary", "mapped"};
+
+/**
+ * @brief Size of the writer thread's batch buffer in bytes.
+ */
+#define LOG_RING_BATCH_SIZE (64 * 1024)
+
+/**
+ * @brief How long the writer thread sleeps when the ring is empty, in
+ * milliseconds. Bounds the latency of a missed wakeup.
+ */
+#define LOG_RING_IDLE_MS 10
+
+/**
+ * @brief A single message slot in the ring.
+ *
+ * @param sequence Slot state: equal to the enqueue position when free, and
+ * to the position + 1 once the message is published.
+ * @param length Length of the formatted message in bytes.
+ * @param message The formatted message.
+ */
+typedef struct LogRingSlot {
+    _Atomic size_t sequence;
+    size_t length;
+    char message[LOG_RING_MESSAGE_SIZE];
+} LogRingSlot;
+
+/**
+ * @brief Bounded multi-producer, single-consumer ring buffer.
+ *
+ * Producers claim slots with a compare-and-swap on head; the writer thread
+ * is the only consumer and owns tail. Based on Dmitry Vyukov's bounded
+ * queue, so a producer never waits on another producer's formatting.
+ */
+struct LogRing {
+    LogRingSlot* slots;
+    size_t mask;
+    _Atomic size_t head;
+    size_t tail;
+    _Atomic size_t written;
+    _Atomic size_t dropped;
+    size_t dropped_reported;
+    LogOverflow overflow;
+    Logger* logger;
+    FILE* file_stream;
+    LogMapped* mapped;
+    pthread_t writer;
+    _Atomic bool running;
+    _Atomic bool sleeping;
+    _Atomic bool draining;
+    pthread_mutex_t wake_lock;
+    pthread_cond_t wake;
+    char batch[LOG_RING_BATCH_SIZE];
+};
+
+// Logger drained by the crash handler
+static Logger* volatile log_crash_logger = NULL;
+
+// Rate-limited sites that have suppressed a message; sites are static, so
+// they are pushed once and never removed
+static LogSite* _Atomic log_sites = NULL;
+
+// Set on writer threads, which must never block on their own full ring
+static _Thread_local bool log_ring_is_writer = false;
+
+/**
+ * @brief Writes the level prefix for a message into buffer.
+ *
+ * @return The number of characters written, clamped to size - 1, or 0 if
+ * size is 0.
+ */
+static size_t logger_format_prefix(char* buffer, size_t size, LogLevel log_level, int err) {
+    int length = 0;
+    switch (log_level) {
+        case LOG_LEVEL_DEBUG:
+            length = snprintf(buffer, size, "[DEBUG] ");
+            break;
+        case LOG_LEVEL_INFO:
+            length = snprintf(buffer, size, "[INFO] ");
+            break;
+        case LOG_LEVEL_WARN:
+            if (err != 0) {
+                length = snprintf(buffer, size, "[WARN:%s] ", strerror(err));
+            } else {
+                length = snprintf(buffer, size, "[WARN] ");
+            }
+            break;
+        case LOG_LEVEL_ERROR:
+            if (err != 0) {
+                length = snprintf(buffer, size, "[ERROR:%s] ", strerror(err));
+            } else {
+                length = snprintf(buffer, size, "[ERROR] ");
+            }
+            break;
+    }
+    if (length < 0 || 0 == size) {
+        return 0;
+    }
+    return (size_t) length < size ? (size_t) length : size - 1;
+}
+
+/**
+ * @brief Longest rotated file name, including the numeric suffix.
+ */
+#define LOG_MAPPED_PATH_SIZE 4096
+
+/**
+ * @brief Space below which a mapped file rotates before formatting; enough
+ * for the level prefix and the start of a message.
+ */
+#define LOG_MAPPED_MIN_ROOM 128
+
+/**
+ * @brief Active file of a mapped logger and its rotation limits.
+ *
+ * @param file_path Path of the active file; rotated files append ".N".
+ * @param fd Descriptor of the active file, or -1 while closed.
+ * @param data Shared mapping of the active file, or NULL while closed.
+ * @param capacity Size of the active file and its mapping in bytes.
+ * @param offset Number of bytes written to the active file.
+ * @param max_files Number of files kept, including the active one.
+ */
+struct LogMapped {
+    const char* file_path;
+    int fd;
+    char* data;
+    size_t capacity;
+    size_t offset;
+    size_t max_files;
+};
+
+/**
+ * @brief Creates the mapped output with default limits, without opening it.
+ */
+static LogMapped* log_mapped_create(const char* file_path) {
+    LogMapped* mapped = (LogMapped*) malloc(sizeof(LogMapped));
+    if (NULL == mapped) {
+        fprintf(stderr, "Failed to allocate memory for mapped log\n");
+        return NULL;
+    }
+
+    mapped->file_path = file_path;
+    mapped->fd = -1;
+    mapped->data = NULL;
+    mapped->capacity = LOG_MAPPED_FILE_SIZE;
+    mapped->offset = 0;
+    mapped->max_files = LOG_MAPPED_FILE_COUNT;
+    return mapped;
+}
+
+/**
+ * @brief Opens the active file, sizes it, and maps it.
+ *
+ * With append set, text already in the file is kept and new messages follow
+ * it; this only happens when rotation could not move the file aside. A file
+ * too full to append to is started over.
+ */
+static bool log_mapped_open(LogMapped* mapped, bool append) {
+    int flags = O_RDWR | O_CREAT | O_CLOEXEC | (append ? 0 : O_TRUNC);
+    mapped->fd = open(mapped->file_path, flags, 0644);
+    if (-1 == mapped->fd) {
+        fprintf(stderr, "Failed to open log file: %s\n", mapped->file_path);
+        return false;
+    }
+
+    size_t existing = 0;
+    struct stat status;
+    if (append && 0 == fstat(mapped->fd, &status)
+        && (size_t) status.st_size + LOG_MAPPED_MIN_ROOM < mapped->capacity) {
+        existing = (size_t) status.st_size;
+    }
+
+    // Shrinking first zeroes everything past the kept text before it is sized up
+    if ((append && 0 != ftruncate(mapped->fd, (off_t) existing))
+        || 0 != ftruncate(mapped->fd, (off_t) mapped->capacity)) {
+        fprintf(stderr, "Failed to size log file: %s\n", mapped->file_path);
+        close(mapped->fd);
+        mapped->fd = -1;
+        return false;
+    }
+
+    void* data = mmap(NULL, mapped->capacity, PROT_READ | PROT_WRITE, MAP_SHARED, mapped->fd, 0);
+    if (MAP_FAILED == data) {
+        fprintf(stderr, "Failed to map log file: %s\n", mapped->file_path);
+        close(mapped->fd);
+        mapped->fd = -1;
+        return false;
+    }
+
+    mapped->data = (char*) data;
+    mapped->offset = existing;
+    return true;
+}
+
+/**
+ * @brief Unmaps the active file and truncates it to what was written.
+ */
+static void log_mapped_close(LogMapped* mapped) {
+    if (NULL == mapped->data) {
+        return;
+    }
+
+    munmap(mapped->data, mapped->capacity);
+    if (0 != ftruncate(mapped->fd, (off_t) mapped->offset)) {
+        fprintf(stderr, "Failed to truncate log file: %s\n", mapped->file_path);
+    }
+    close(mapped->fd);
+    mapped->fd = -1;
+    mapped->data = NULL;
+}
+
+/**
+ * @brief Shifts "<path>" to "<path>.1", "<path>.1" to "<path>.2", and so on.
+ *
+ * rename replaces its target, so the oldest file drops off the end.
+ */
+static void log_mapped_shift(const LogMapped* mapped) {
+    char source[LOG_MAPPED_PATH_SIZE];
+    char target[LOG_MAPPED_PATH_SIZE];
+
+    for (size_t i = mapped->max_files - 1; i > 0; i--) {
+        if (i == 1) {
+            snprintf(source, sizeof(source), "%s", mapped->file_path);
+        } else {
+            snprintf(source, sizeof(source), "%s.%zu", mapped->file_path, i - 1);
+        }
+        snprintf(target, sizeof(target), "%s.%zu", mapped->file_path, i);
+        rename(source, target); // Missing sources are expected before the first rotations
+    }
+}
+
+/**
+ * @brief Closes the active file, shifts the kept files, and opens a new one.
+ */
+static bool log_mapped_rotate(LogMapped* mapped) {
+    log_mapped_close(mapped);
+    log_mapped_shift(mapped);
+    return log_mapped_open(mapped, false);
+}
+
+/**
+ * @brief Truncates a file left by an earlier run to its contents.
+ *
+ * A process that died with the file mapped leaves the unused space as NUL
+ * padding up to the file size.
+ *
+ * @return The length of the contents, or 0 if the file is missing or empty.
+ */
+static size_t log_mapped_trim(const char* file_path) {
+    int err = errno; // A missing file is the usual case, not the caller's error
+    int fd = open(file_path, O_RDWR | O_CLOEXEC);
+    if (-1 == fd) {
+        errno = err;
+        return 0;
+    }
+
+    struct stat status;
+    if (0 != fstat(fd, &status) || 0 == status.st_size) {
+        close(fd);
+        return 0;
+    }
+
+    size_t size = (size_t) status.st_size;
+    const char* data = (const char*) mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (MAP_FAILED == data) {
+        close(fd);
+        return size; // Keep it whole rather than lose it
+    }
+
+    size_t length = size;
+    while (length > 0 && '\0' == data[length - 1]) {
+        length--;
+    }
+    munmap((void*) data, size);
+
+    if (length < size && 0 != ftruncate(fd, (off_t) length)) {
+        fprintf(stderr, "Failed to truncate log file: %s\n", file_path);
+    }
+    close(fd);
+    return length;
+}
+
+/**
+ * @brief Copies preformatted text into the active file.
+ *
+ * Text that does not fit is truncated when rotation is not allowed, which
+ * keeps the function async-signal-safe for the crash handler.
+ */
+static void log_mapped_write(LogMapped* mapped, const char* text, size_t length, bool may_rotate) {
+    if (NULL == mapped->data) {
+        return;
+    }
+
+    if (length > mapped->capacity - mapped->offset && may_rotate && mapped->offset > 0) {
+        if (!log_mapped_rotate(mapped)) {
+            return;
+        }
+    }
+
+    size_t room = mapped->capacity - mapped->offset;
+    if (length > room) {
+        length = room;
+    }
+    memcpy(mapped->data + mapped->offset, text, length);
+    mapped->offset += length;
+}
+
+/**
+ * @brief Formats a message directly into the active file, rotating once if
+ * it does not fit.
+ *
+ * A message larger than a whole file is truncated to the file size.
+ */
+static void log_mapped_vprintf(
+    LogMapped* mapped, LogLevel log_level, int err, const char* format, va_list args
+) {
+    for (int attempt = 0; attempt < 2 && mapped->data; attempt++) {
+        char* start = mapped->data + mapped->offset;
+        size_t room = mapped->capacity - mapped->offset;
+
+        // A full or nearly full file rotates first; with no room at all the message is dropped
+        if (room < LOG_MAPPED_MIN_ROOM && mapped->offset > 0 && 0 == attempt) {
+            if (!log_mapped_rotate(mapped)) {
+                return;
+            }
+            continue;
+        }
+        if (0 == room) {
+            return;
+        }
+
+        size_t length = logger_format_prefix(start, room, log_level, err);
+        va_list copy;
+        va_copy(copy, args);
+        int written = vsnprintf(start + length, room - length, format, copy);
+        va_end(copy);
+        if (written > 0) {
+            length += (size_t) written;
+        }
+
+        // vsnprintf needs room for its terminator, which the next message overwrites
+        if (length < room) {
+            mapped->offset += length;
+            return;
+        }
+        if (0 == mapped->offset || attempt > 0) {
+            mapped->offset = mapped->capacity; // Keep the truncated message
+            return;
+        }
+
+        // Erase the partial message so a crash never leaves it behind
+        memset(start, 0, room);
+        if (!log_mapped_rotate(mapped)) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Opens the logger's mapped output, falling back to stderr on failure.
+ *
+ * The caller must hold the logger's mutex, or own the logger exclusively.
+ */
+static bool logger_open_mapped(Logger* logger) {
+    if (logger->mapped && logger->mapped->data) {
+        return true;
+    }
+
+    if (NULL != logger->file_path) {
+        if (NULL == logger->mapped) {
+            logger->mapped = log_mapped_create(logger->file_path);
+        }
+        // Move the previous run's log aside instead of overwriting it
+        if (logger->mapped && log_mapped_trim(logger->file_path) > 0) {
+            log_mapped_shift(logger->mapped);
+        }
+        if (logger->mapped && log_mapped_open(logger->mapped, true)) {
+            return true;
+        }
+    }
+
+    // set the logger type to stream upon failure.
+    set_logger_type_and_name(logger, LOG_TYPE_STREAM);
+    logger->file_stream = stderr;
+    return false;
+}
 
 /**
  * @brief Sets the logger type and name.
@@ -38,6 +434,14 @@ bool set_logger_type_and_name(Logger* logger, LogType log_type) {
             logger->log_type = LOG_TYPE_FILE;
             logger->log_type_name = LOG_TYPE_NAME[LOG_TYPE_FILE];
             return true;
+        case LOG_TYPE_BINARY:
+            logger->log_type = LOG_TYPE_BINARY;
+            logger->log_type_name = LOG_TYPE_NAME[LOG_TYPE_BINARY];
+            return true;
+        case LOG_TYPE_MAPPED:
+            logger->log_type = LOG_TYPE_MAPPED;
+            logger->log_type_name = LOG_TYPE_NAME[LOG_TYPE_MAPPED];
+            return true;
         default:
             fprintf(stderr, "Invalid logger type\n");
             return false;
@@ -104,7 +508,7 @@ Logger* logger_new(LogType log_type) {
     }
 
     // Set default values for the logger
-    logger->log_level = LOG_LEVEL_DEBUG;
+    atomic_init(&logger->log_level, LOG_LEVEL_DEBUG);
 
     // Set logger type and name
     if (!set_logger_type_and_name(logger, log_type)) {
@@ -115,6 +519,10 @@ Logger* logger_new(LogType log_type) {
 
     logger->file_path = NULL;
     logger->file_stream = NULL;
+    atomic_init(&logger->ring, NULL);
+    atomic_init(&logger->ring_users, 0);
+    logger->binary = NULL;
+    logger->mapped = NULL;
 
     // Initialize the mutex for thread safety
     int error_code = pthread_mutex_init(&logger->thread_lock, NULL);
@@ -152,7 +560,7 @@ Logger* logger_create(LogLevel log_level, LogType log_type, const char* file_pat
     }
 
     // Set the log level
-    logger->log_level = log_level;
+    logger_set_level(logger, log_level);
 
     // Set the file path and stream based on the logger type
     switch (log_type) {
@@ -162,10 +570,17 @@ Logger* logger_create(LogLevel log_level, LogType log_type, const char* file_pat
             logger->file_stream = stderr;
             break;
         case LOG_TYPE_FILE:
+        case LOG_TYPE_BINARY:
             if (!set_logger_file_path_and_stream(logger, file_path)) {
                 fprintf(stderr, "Failed to set log file path. Fallback to stderr.\n");
             }
             break;
+        case LOG_TYPE_MAPPED:
+            logger->file_path = file_path;
+            if (!logger_open_mapped(logger)) {
+                fprintf(stderr, "Failed to map log file. Fallback to stderr.\n");
+            }
+            break;
         default:
             // Unknown logger type; fallback to stderr
             fprintf(stderr, "Unknown logger type. Fallback to stderr.\n");
@@ -176,6 +591,17 @@ Logger* logger_create(LogLevel log_level, LogType log_type, const char* file_pat
     return logger;
 }
 
+/**
+ * @brief Detaches a logger's sites so nothing reports to it once it is freed.
+ */
+static void log_sites_forget(Logger* logger) {
+    LogSite* site = atomic_load_explicit(&log_sites, memory_order_acquire);
+    for (; site; site = site->next) {
+        Logger* expected = logger;
+        atomic_compare_exchange_strong(&site->logger, &expected, NULL);
+    }
+}
+
 /**
  * @brief Destroys a logger instance and releases associated resources.
  *
@@ -190,8 +616,27 @@ bool logger_free(Logger* logger) {
         return false;
     }
 
+    // Report pending repeat counts, then drain and stop the writer thread
+    // before closing its stream
+    log_sites_flush(logger, true);
+    logger_stop_async(logger);
+    log_sites_forget(logger);
+
+    // Write out buffered binary records
+    logger_flush_binary(logger);
+    free(logger->binary);
+    logger->binary = NULL;
+
+    // Truncate the mapped file to its contents
+    if (logger->mapped) {
+        log_mapped_close(logger->mapped);
+        free(logger->mapped);
+        logger->mapped = NULL;
+    }
+
     // Close the log file if it's a file logger
-    if (LOG_TYPE_FILE == logger->log_type && NULL != logger->file_stream) {
+    if ((LOG_TYPE_FILE == logger->log_type || LOG_TYPE_BINARY == logger->log_type)
+        && NULL != logger->file_stream) {
         if (fclose(logger->file_stream) != 0) {
             fprintf(stderr, "Failed to close log file: %s\n", logger->file_path);
             return false; // return false to prevent dangling pointers
@@ -210,6 +655,828 @@ bool logger_free(Logger* logger) {
     return true;
 }
 
+/**
+ * @brief Formats a message into a free ring slot and publishes it.
+ *
+ * @return True if the message was queued, false if it was dropped.
+ */
+static bool log_ring_push(
+    LogRing* ring, LogLevel log_level, int err, const char* format, va_list args
+) {
+    LogRingSlot* slot;
+    size_t position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    // Claim a slot
+    for (;;) {
+        slot = &ring->slots[position & ring->mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t) sequence - (intptr_t) position;
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(
+                    &ring->head, &position, position + 1, memory_order_relaxed, memory_order_relaxed
+                )) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The ring is full
+            if (ring->overflow == LOG_OVERFLOW_DROP || log_ring_is_writer) {
+                atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+                return false;
+            }
+            if (atomic_load_explicit(&ring->sleeping, memory_order_relaxed)) {
+                pthread_mutex_lock(&ring->wake_lock);
+                pthread_cond_signal(&ring->wake);
+                pthread_mutex_unlock(&ring->wake_lock);
+            }
+            sched_yield();
+            position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        } else {
+            position = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        }
+    }
+
+    // Format directly into the claimed slot
+    size_t length = logger_format_prefix(slot->message, LOG_RING_MESSAGE_SIZE, log_level, err);
+    int written = vsnprintf(
+        slot->message + length, LOG_RING_MESSAGE_SIZE - length, format, args
+    );
+    if (written > 0) {
+        length += (size_t) written;
+    }
+    if (length >= LOG_RING_MESSAGE_SIZE) {
+        // Truncated; keep the trailing newline so lines stay separated
+        length = LOG_RING_MESSAGE_SIZE - 1;
+        slot->message[length - 1] = '\n';
+    }
+    slot->length = length;
+
+    // Publish the slot to the writer
+    atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+
+    // Wake the writer only if it went idle
+    if (atomic_load_explicit(&ring->sleeping, memory_order_relaxed)) {
+        pthread_mutex_lock(&ring->wake_lock);
+        pthread_cond_signal(&ring->wake);
+        pthread_mutex_unlock(&ring->wake_lock);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Moves published messages into the batch buffer and writes them.
+ *
+ * Only one thread may drain at a time; the caller must own ring->draining.
+ *
+ * @return The number of messages written.
+ */
+static size_t log_ring_drain(LogRing* ring, bool signal_safe) {
+    size_t count = 0;
+    size_t batch_length = 0;
+    int fd = ring->mapped ? -1 : fileno(ring->file_stream);
+
+    for (;;) {
+        LogRingSlot* slot = &ring->slots[ring->tail & ring->mask];
+        size_t sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        bool ready = sequence == ring->tail + 1;
+
+        // Write the batch when it is full or the ring is empty
+        if (batch_length > 0 && (!ready || batch_length + slot->length > LOG_RING_BATCH_SIZE)) {
+            if (signal_safe) {
+                ssize_t result = write(fd, ring->batch, batch_length);
+                (void) result;
+            } else {
+                fwrite(ring->batch, 1, batch_length, ring->file_stream);
+            }
+            batch_length = 0;
+        }
+        if (!ready) {
+            break;
+        }
+
+        if (ring->mapped) {
+            // Already a memcpy; batching would only split messages across rotations
+            log_mapped_write(ring->mapped, slot->message, slot->length, !signal_safe);
+        } else {
+            memcpy(ring->batch + batch_length, slot->message, slot->length);
+            batch_length += slot->length;
+        }
+        count++;
+
+        // Hand the slot back to producers one lap ahead
+        atomic_store_explicit(&slot->sequence, ring->tail + ring->mask + 1, memory_order_release);
+        ring->tail++;
+    }
+
+    if (!signal_safe && count > 0 && NULL == ring->mapped) {
+        fflush(ring->file_stream);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Writer thread: drains the ring until stopped.
+ */
+static void* log_ring_writer(void* arg) {
+    LogRing* ring = (LogRing*) arg;
+    log_ring_is_writer = true;
+
+    for (;;) {
+        bool running = atomic_load_explicit(&ring->running, memory_order_acquire);
+
+        size_t count = 0;
+        if (!atomic_exchange_explicit(&ring->draining, true, memory_order_acquire)) {
+            count = log_ring_drain(ring, false);
+            atomic_store_explicit(&ring->written, ring->tail, memory_order_release);
+
+            // Report drops once the ring has room again
+            size_t dropped = atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+            if (dropped != ring->dropped_reported) {
+                char report[64];
+                int length = snprintf(
+                    report,
+                    sizeof(report),
+                    "[WARN] %zu log messages dropped (ring full)\n",
+                    dropped - ring->dropped_reported
+                );
+                if (ring->mapped) {
+                    log_mapped_write(ring->mapped, report, (size_t) length, true);
+                } else {
+                    fputs(report, ring->file_stream);
+                    fflush(ring->file_stream);
+                }
+                ring->dropped_reported = dropped;
+            }
+
+            atomic_store_explicit(&ring->draining, false, memory_order_release);
+        }
+
+        if (!running) {
+            break; // Drained after the stop request was observed
+        }
+
+        // Report counts from this logger's sites whose interval ended without another message
+        log_sites_flush(ring->logger, false);
+
+        if (count == 0) {
+            // Idle: sleep until a producer signals or the timeout expires
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += LOG_RING_IDLE_MS * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+
+            pthread_mutex_lock(&ring->wake_lock);
+            atomic_store_explicit(&ring->sleeping, true, memory_order_relaxed);
+            pthread_cond_timedwait(&ring->wake, &ring->wake_lock, &deadline);
+            atomic_store_explicit(&ring->sleeping, false, memory_order_relaxed);
+            pthread_mutex_unlock(&ring->wake_lock);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Signal handler that drains the crash logger's ring and re-raises.
+ */
+static void logger_crash_handler(int signal_number) {
+    Logger* logger = log_crash_logger;
+    LogRing* ring = logger ? logger->ring : NULL;
+    if (ring) {
+
+        // Give a writer mid-batch a moment, then take over regardless
+        for (int i = 0; i < 1000000; i++) {
+            if (!atomic_exchange_explicit(&ring->draining, true, memory_order_acquire)) {
+                break;
+            }
+        }
+        log_ring_drain(ring, true);
+    }
+
+    signal(signal_number, SIG_DFL);
+    raise(signal_number);
+}
+
+bool logger_start_async(Logger* logger, size_t capacity, LogOverflow overflow) {
+    if (logger->ring) {
+        fprintf(stderr, "Logger is already asynchronous\n");
+        return false;
+    }
+    if (LOG_TYPE_BINARY == logger->log_type) {
+        // The ring carries formatted text, which would corrupt the record stream
+        fprintf(stderr, "Binary loggers cannot be made asynchronous\n");
+        return false;
+    }
+
+    // Round capacity up to a power of 2 so positions wrap with a mask
+    size_t slots = 2;
+    while (slots < capacity) {
+        slots <<= 1;
+    }
+
+    LogRing* ring = (LogRing*) malloc(sizeof(LogRing));
+    if (NULL == ring) {
+        fprintf(stderr, "Failed to allocate memory for log ring\n");
+        return false;
+    }
+
+    ring->slots = (LogRingSlot*) malloc(slots * sizeof(LogRingSlot));
+    if (NULL == ring->slots) {
+        fprintf(stderr, "Failed to allocate memory for log ring slots\n");
+        free(ring);
+        return false;
+    }
+
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(&ring->slots[i].sequence, i);
+    }
+    ring->mask = slots - 1;
+    atomic_init(&ring->head, 0);
+    ring->tail = 0;
+    atomic_init(&ring->written, 0);
+    atomic_init(&ring->dropped, 0);
+    ring->dropped_reported = 0;
+    ring->overflow = overflow;
+    ring->logger = logger;
+    ring->file_stream = logger->file_stream ? logger->file_stream : stderr;
+    ring->mapped = NULL;
+    if (LOG_TYPE_MAPPED == logger->log_type) {
+        // Writer thread owns the mapped file from here on
+        pthread_mutex_lock(&logger->thread_lock);
+        if (logger_open_mapped(logger)) {
+            ring->mapped = logger->mapped;
+        }
+        pthread_mutex_unlock(&logger->thread_lock);
+    }
+    atomic_init(&ring->running, true);
+    atomic_init(&ring->sleeping, false);
+    atomic_init(&ring->draining, false);
+    pthread_mutex_init(&ring->wake_lock, NULL);
+    pthread_cond_init(&ring->wake, NULL);
+
+    // Flush anything written synchronously so output stays ordered
+    fflush(ring->file_stream);
+
+    int error_code = pthread_create(&ring->writer, NULL, log_ring_writer, ring);
+    if (0 != error_code) {
+        fprintf(stderr, "Failed to start log writer thread with error: %d\n", error_code);
+        pthread_cond_destroy(&ring->wake);
+        pthread_mutex_destroy(&ring->wake_lock);
+        free(ring->slots);
+        free(ring);
+        return false;
+    }
+
+    atomic_store(&logger->ring, ring);
+    return true;
+}
+
+bool logger_stop_async(Logger* logger) {
+    if (NULL == logger->ring) {
+        return false;
+    }
+
+    // Queue pending repeat counts while the writer can still drain them
+    log_sites_flush(logger, true);
+
+    // New messages take the synchronous path; wait out those already pushing
+    LogRing* ring = atomic_exchange(&logger->ring, NULL);
+    if (NULL == ring) {
+        return false;
+    }
+    while (atomic_load(&logger->ring_users) != 0) {
+        sched_yield();
+    }
+
+    // The writer drains once more after observing the stop request
+    atomic_store_explicit(&ring->running, false, memory_order_release);
+    pthread_mutex_lock(&ring->wake_lock);
+    pthread_cond_signal(&ring->wake);
+    pthread_mutex_unlock(&ring->wake_lock);
+    pthread_join(ring->writer, NULL);
+
+    if (log_crash_logger == logger) {
+        log_crash_logger = NULL;
+    }
+
+    pthread_cond_destroy(&ring->wake);
+    pthread_mutex_destroy(&ring->wake_lock);
+    free(ring->slots);
+    free(ring);
+    return true;
+}
+
+void logger_flush(Logger* logger) {
+    LogRing* ring = logger->ring;
+    if (NULL == ring) {
+        return;
+    }
+
+    // Wait until the writer has written everything claimed so far
+    size_t target = atomic_load_explicit(&ring->head, memory_order_acquire);
+    while ((intptr_t) (atomic_load_explicit(&ring->written, memory_order_acquire) - target) < 0) {
+        pthread_mutex_lock(&ring->wake_lock);
+        pthread_cond_signal(&ring->wake);
+        pthread_mutex_unlock(&ring->wake_lock);
+        sched_yield();
+    }
+}
+
+size_t logger_dropped(const Logger* logger) {
+    LogRing* ring = logger->ring;
+    if (NULL == ring) {
+        return 0;
+    }
+    return atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+}
+
+bool logger_install_crash_handler(Logger* logger) {
+    log_crash_logger = logger;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = logger_crash_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND;
+
+    const int signals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+    for (size_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+        if (sigaction(signals[i], &action, NULL) != 0) {
+            fprintf(stderr, "Failed to install crash handler for signal %d\n", signals[i]);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Size of the binary record buffer in bytes.
+ */
+#define LOG_BINARY_BUFFER_SIZE (64 * 1024)
+
+/**
+ * @brief Largest encoded record; longer string arguments are truncated.
+ */
+#define LOG_BINARY_RECORD_SIZE (4 * 1024)
+
+/**
+ * @brief Number of format string pointers remembered as already defined.
+ */
+#define LOG_BINARY_FORMAT_COUNT 1024
+
+/**
+ * @brief Binary record buffer.
+ *
+ * Records are appended under the logger's mutex and written out when the
+ * buffer fills. Each format string is emitted once as a definition record
+ * keyed by its address; messages then refer to it by that key.
+ */
+struct LogBinary {
+    size_t length;
+    const char* formats[LOG_BINARY_FORMAT_COUNT];
+    uint8_t buffer[LOG_BINARY_BUFFER_SIZE];
+};
+
+const char* log_format_next(const char* format, LogFormatSpec* spec) {
+    const char* p = strchr(format, '%');
+    if (NULL == p) {
+        return NULL;
+    }
+
+    spec->start = p++;
+    spec->width = LOG_ARG_NONE;
+    spec->precision = LOG_ARG_NONE;
+    spec->value = LOG_ARG_NONE;
+
+    // Flags
+    while (*p && strchr("-+ #0'", *p)) {
+        p++;
+    }
+
+    // Width
+    if (*p == '*') {
+        spec->width = LOG_ARG_INT;
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+
+    // Precision
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->precision = LOG_ARG_INT;
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') {
+                p++;
+            }
+        }
+    }
+
+    // Length modifier
+    LogArgType integer = LOG_ARG_INT;
+    bool long_double = false;
+    switch (*p) {
+        case 'h':
+            p += (p[1] == 'h') ? 2 : 1; // Promoted to int
+            break;
+        case 'l':
+            integer = (p[1] == 'l') ? LOG_ARG_LLONG : LOG_ARG_LONG;
+            p += (p[1] == 'l') ? 2 : 1;
+            break;
+        case 'j':
+            integer = LOG_ARG_INTMAX;
+            p++;
+            break;
+        case 'z':
+            integer = LOG_ARG_SIZE;
+            p++;
+            break;
+        case 't':
+            integer = LOG_ARG_PTRDIFF;
+            p++;
+            break;
+        case 'L':
+            long_double = true;
+            p++;
+            break;
+        default:
+            break;
+    }
+
+    // Conversion
+    switch (*p) {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+        case 'c':
+            spec->value = integer;
+            break;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            spec->value = long_double ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+            break;
+        case 's':
+            spec->value = LOG_ARG_STRING;
+            break;
+        case 'p':
+        case 'n':
+            spec->value = LOG_ARG_POINTER;
+            break;
+        case '%':
+        default:
+            break;
+    }
+
+    if (*p) {
+        p++;
+    }
+    spec->length = (size_t) (p - spec->start);
+    return p;
+}
+
+/**
+ * @brief Appends bytes to a record if they fit.
+ */
+static bool log_binary_put(uint8_t* record, size_t* length, const void* data, size_t size) {
+    if (size > LOG_BINARY_RECORD_SIZE - *length) {
+        return false;
+    }
+    memcpy(record + *length, data, size);
+    *length += size;
+    return true;
+}
+
+/**
+ * @brief Reads one argument of the given type and appends it to a record.
+ */
+static void log_binary_put_arg(uint8_t* record, size_t* length, LogArgType type, va_list* args) {
+    uint64_t value = 0;
+    switch (type) {
+        case LOG_ARG_NONE:
+            return;
+        case LOG_ARG_INT:
+            value = (uint64_t) (int64_t) va_arg(*args, int);
+            break;
+        case LOG_ARG_LONG:
+            value = (uint64_t) (int64_t) va_arg(*args, long);
+            break;
+        case LOG_ARG_LLONG:
+            value = (uint64_t) va_arg(*args, long long);
+            break;
+        case LOG_ARG_SIZE:
+            value = (uint64_t) va_arg(*args, size_t);
+            break;
+        case LOG_ARG_INTMAX:
+            value = (uint64_t) va_arg(*args, intmax_t);
+            break;
+        case LOG_ARG_PTRDIFF:
+            value = (uint64_t) (int64_t) va_arg(*args, ptrdiff_t);
+            break;
+        case LOG_ARG_DOUBLE: {
+            double number = va_arg(*args, double);
+            memcpy(&value, &number, sizeof(value));
+            break;
+        }
+        case LOG_ARG_LDOUBLE: {
+            uint8_t bytes[16] = {0};
+            long double number = va_arg(*args, long double);
+            memcpy(bytes, &number, sizeof(number) < sizeof(bytes) ? sizeof(number) : sizeof(bytes));
+            log_binary_put(record, length, bytes, sizeof(bytes));
+            return;
+        }
+        case LOG_ARG_STRING: {
+            const char* string = va_arg(*args, const char*);
+            uint32_t size = UINT32_MAX; // NULL marker
+            if (string) {
+                size_t available = LOG_BINARY_RECORD_SIZE - *length;
+                size_t string_length = strlen(string);
+                available = available > sizeof(size) ? available - sizeof(size) : 0;
+                size = (uint32_t) (string_length < available ? string_length : available);
+            }
+            log_binary_put(record, length, &size, sizeof(size));
+            if (string) {
+                log_binary_put(record, length, string, size);
+            }
+            return;
+        }
+        case LOG_ARG_POINTER:
+            value = (uint64_t) (uintptr_t) va_arg(*args, void*);
+            break;
+    }
+    log_binary_put(record, length, &value, sizeof(value));
+}
+
+/**
+ * @brief Copies an encoded record into the buffer, writing it out when full.
+ */
+static void log_binary_append(
+    LogBinary* binary, FILE* file_stream, const uint8_t* record, size_t length
+) {
+    if (length > LOG_BINARY_BUFFER_SIZE - binary->length) {
+        fwrite(binary->buffer, 1, binary->length, file_stream);
+        binary->length = 0;
+    }
+    memcpy(binary->buffer + binary->length, record, length);
+    binary->length += length;
+}
+
+/**
+ * @brief Records a message without formatting it.
+ *
+ * The caller must hold the logger's mutex.
+ */
+static void log_binary_record(
+    Logger* logger, LogLevel log_level, int err, const char* format, va_list args
+) {
+    LogBinary* binary = logger->binary;
+    if (NULL == binary) {
+        binary = (LogBinary*) calloc(1, sizeof(LogBinary));
+        if (NULL == binary) {
+            fprintf(stderr, "Failed to allocate memory for binary log buffer\n");
+            return;
+        }
+        logger->binary = binary;
+
+        // File header: magic followed by the record layout version
+        uint32_t version = LOG_BINARY_VERSION;
+        memcpy(binary->buffer, LOG_BINARY_MAGIC, 8);
+        memcpy(binary->buffer + 8, &version, sizeof(version));
+        binary->length = 8 + sizeof(version);
+    }
+
+    uint8_t record[LOG_BINARY_RECORD_SIZE];
+    size_t length = 0;
+    uint64_t id = (uint64_t) (uintptr_t) format;
+
+    // Emit the format string the first time its address is seen
+    size_t slot = (size_t) ((id >> 3) % LOG_BINARY_FORMAT_COUNT);
+    bool defined = false;
+    for (size_t i = 0; i < LOG_BINARY_FORMAT_COUNT; i++) {
+        const char** entry = &binary->formats[(slot + i) % LOG_BINARY_FORMAT_COUNT];
+        if (*entry == format) {
+            defined = true;
+            break;
+        }
+        if (NULL == *entry) {
+            *entry = format;
+            break;
+        }
+    }
+    if (!defined) {
+        uint32_t size = (uint32_t) strlen(format);
+        uint8_t tag = 'F';
+        if (sizeof(tag) + sizeof(id) + sizeof(size) + size <= LOG_BINARY_RECORD_SIZE) {
+            log_binary_put(record, &length, &tag, sizeof(tag));
+            log_binary_put(record, &length, &id, sizeof(id));
+            log_binary_put(record, &length, &size, sizeof(size));
+            log_binary_put(record, &length, format, size);
+            log_binary_append(binary, logger->file_stream, record, length);
+            length = 0;
+        }
+    }
+
+    // Message header: tag, level, errno, format key, timestamp, payload size
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t timestamp = (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+    uint8_t tag = 'M';
+    uint8_t level = (uint8_t) log_level;
+    int32_t error = (int32_t) err;
+    uint32_t payload = 0;
+    log_binary_put(record, &length, &tag, sizeof(tag));
+    log_binary_put(record, &length, &level, sizeof(level));
+    log_binary_put(record, &length, &error, sizeof(error));
+    log_binary_put(record, &length, &id, sizeof(id));
+    log_binary_put(record, &length, &timestamp, sizeof(timestamp));
+    size_t payload_offset = length;
+    log_binary_put(record, &length, &payload, sizeof(payload));
+
+    // Raw argument values in format order
+    va_list copy;
+    va_copy(copy, args);
+    LogFormatSpec spec;
+    for (const char* p = log_format_next(format, &spec); p; p = log_format_next(p, &spec)) {
+        log_binary_put_arg(record, &length, spec.width, &copy);
+        log_binary_put_arg(record, &length, spec.precision, &copy);
+        log_binary_put_arg(record, &length, spec.value, &copy);
+    }
+    va_end(copy);
+
+    payload = (uint32_t) (length - payload_offset - sizeof(payload));
+    memcpy(record + payload_offset, &payload, sizeof(payload));
+    log_binary_append(binary, logger->file_stream, record, length);
+}
+
+void logger_flush_binary(Logger* logger) {
+    pthread_mutex_lock(&logger->thread_lock);
+    if (logger->binary && logger->binary->length > 0 && logger->file_stream) {
+        fwrite(logger->binary->buffer, 1, logger->binary->length, logger->file_stream);
+        fflush(logger->file_stream);
+        logger->binary->length = 0;
+    }
+    pthread_mutex_unlock(&logger->thread_lock);
+}
+
+static uint64_t log_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+/**
+ * @brief Pushes a site onto log_sites the first time it suppresses a message.
+ */
+static void log_site_register(
+    LogSite* site, Logger* logger, LogLevel level, const char* file, const char* func, int line
+) {
+    if (atomic_exchange_explicit(&site->registered, true, memory_order_relaxed)) {
+        // A site detached by logger_free reports to the next logger that reaches it
+        Logger* detached = NULL;
+        atomic_compare_exchange_strong(&site->logger, &detached, logger);
+        return;
+    }
+
+    atomic_store_explicit(&site->logger, logger, memory_order_relaxed);
+    site->level = level;
+    site->file = file;
+    site->func = func;
+    site->line = line;
+
+    // Releasing the new head publishes the fields above to log_sites_flush
+    LogSite* head = atomic_load_explicit(&log_sites, memory_order_relaxed);
+    do {
+        site->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(
+        &log_sites, &head, site, memory_order_release, memory_order_relaxed
+    ));
+}
+
+bool log_site_allow(
+    LogSite* site,
+    Logger* logger,
+    LogLevel level,
+    const char* file,
+    const char* func,
+    int line,
+    uint64_t interval_ns,
+    uint32_t* suppressed
+) {
+    uint64_t now_ns = log_now_ns();
+
+    uint64_t next_ns = atomic_load_explicit(&site->next_ns, memory_order_relaxed);
+    if (now_ns < next_ns
+        || !atomic_compare_exchange_strong_explicit(
+            &site->next_ns,
+            &next_ns,
+            now_ns + interval_ns,
+            memory_order_relaxed,
+            memory_order_relaxed
+        )) {
+        // Too soon, or another thread just claimed this interval
+        atomic_fetch_add_explicit(&site->suppressed, 1, memory_order_relaxed);
+        log_site_register(site, logger, level, file, func, line);
+        return false;
+    }
+
+    *suppressed = atomic_exchange_explicit(&site->suppressed, 0, memory_order_relaxed);
+    return true;
+}
+
+void log_sites_flush(Logger* logger, bool force) {
+    uint64_t now_ns = log_now_ns();
+    LogSite* site = atomic_load_explicit(&log_sites, memory_order_acquire);
+    for (; site; site = site->next) {
+        Logger* target = atomic_load(&site->logger);
+        if (NULL == target || (logger && target != logger)
+            || 0 == atomic_load_explicit(&site->suppressed, memory_order_relaxed)) {
+            continue;
+        }
+        if (!force && now_ns < atomic_load_explicit(&site->next_ns, memory_order_relaxed)) {
+            continue; // The site's next message may still carry the count
+        }
+
+        // Whoever takes the count reports it, so it is never logged twice
+        uint32_t count = atomic_exchange_explicit(&site->suppressed, 0, memory_order_relaxed);
+        if (count > 0) {
+            logger_message(
+                target,
+                site->level,
+                "[%s:%s:%d] Last message repeated %u times\n",
+                site->file,
+                site->func,
+                site->line,
+                count
+            );
+        }
+    }
+}
+
+bool logger_set_rotation(Logger* logger, size_t max_file_size, size_t max_files) {
+    if (LOG_TYPE_MAPPED != logger->log_type || NULL == logger->file_path || 0 == max_file_size
+        || 0 == max_files) {
+        fprintf(stderr, "Invalid rotation limits for logger type: %s\n", logger->log_type_name);
+        return false;
+    }
+
+    pthread_mutex_lock(&logger->thread_lock);
+
+    // The writer thread copies into the mapping without the lock, so it must not be remapped
+    if (NULL != atomic_load(&logger->ring)) {
+        pthread_mutex_unlock(&logger->thread_lock);
+        fprintf(stderr, "Cannot change rotation limits of an asynchronous logger\n");
+        return false;
+    }
+
+    if (NULL == logger->mapped) {
+        logger->mapped = log_mapped_create(logger->file_path);
+        if (NULL == logger->mapped) {
+            pthread_mutex_unlock(&logger->thread_lock);
+            return false;
+        }
+    }
+
+    // An open file is rotated so the new size takes effect immediately
+    LogMapped* mapped = logger->mapped;
+    bool reopen = NULL != mapped->data;
+    log_mapped_close(mapped);
+    mapped->capacity = max_file_size;
+    mapped->max_files = max_files;
+
+    bool result = true;
+    if (reopen) {
+        if (mapped->offset > 0) {
+            log_mapped_shift(mapped); // Nothing worth keeping in an empty file
+        }
+        result = log_mapped_open(mapped, false);
+    }
+
+    pthread_mutex_unlock(&logger->thread_lock);
+    return result;
+}
+
+void logger_set_level(Logger* logger, LogLevel log_level) {
+    atomic_store_explicit(&logger->log_level, log_level, memory_order_relaxed);
+}
+
 /**
  * @brief Logs a message with the specified log level to the logger's file.
  *
@@ -226,13 +1493,28 @@ bool logger_free(Logger* logger) {
  */
 bool logger_message(Logger* logger, LogLevel log_level, const char* format, ...) {
     // block if and only if the LogLevel is less than the logger->LogLevel
-    if (log_level < logger->log_level) {
+    if (!logger_enabled(logger, log_level)) {
         return false; // Do not log messages below the current
                       // logger->LogLevel
     }
 
     int err = errno; // Capture errno at the start of the function to avoid changes
 
+    // Hand the message to the writer thread in asynchronous mode. Registering
+    // before loading the ring keeps logger_stop_async from freeing it under us;
+    // both sides use sequentially consistent operations for that reason.
+    atomic_fetch_add(&logger->ring_users, 1);
+    LogRing* ring = atomic_load(&logger->ring);
+    if (ring) {
+        va_list args;
+        va_start(args, format);
+        bool queued = log_ring_push(ring, log_level, err, format, args);
+        va_end(args);
+        atomic_fetch_sub(&logger->ring_users, 1);
+        return queued;
+    }
+    atomic_fetch_sub(&logger->ring_users, 1);
+
     // Apply lazy initialization for global logger
     if (NULL == logger->file_stream) {
         logger->file_stream = stderr;
@@ -242,6 +1524,26 @@ bool logger_message(Logger* logger, LogLevel log_level, const char* format, ...)
     // Only lock the thread if LogLevel is valid!
     pthread_mutex_lock(&logger->thread_lock);
 
+    // Format straight into the mapped file; no flush is needed
+    if (LOG_TYPE_MAPPED == logger->log_type && logger_open_mapped(logger)) {
+        va_list args;
+        va_start(args, format);
+        log_mapped_vprintf(logger->mapped, log_level, err, format, args);
+        va_end(args);
+        pthread_mutex_unlock(&logger->thread_lock);
+        return true;
+    }
+
+    // Record raw arguments and defer formatting to the offline decoder
+    if (LOG_TYPE_BINARY == logger->log_type) {
+        va_list args;
+        va_start(args, format);
+        log_binary_record(logger, log_level, err, format, args);
+        va_end(args);
+        pthread_mutex_unlock(&logger->thread_lock);
+        return true;
+    }
+
     // Prefix log messages based on the level
     switch (log_level) {
         case LOG_LEVEL_DEBUG:
@@ -310,7 +1612,11 @@ Logger global_logger = {
     "stream", /**< Logger type name */
     NULL, /**< File stream */
     NULL, /**< File path */
-    PTHREAD_MUTEX_INITIALIZER /**< Mutex for thread safety */
+    PTHREAD_MUTEX_INITIALIZER, /**< Mutex for thread safety */
+    NULL, /**< Async ring buffer */
+    0, /**< Producers using the ring */
+    NULL, /**< Binary record buffer */
+    NULL /**< Mapped output */
 };
 
 /**
@@ -339,7 +1645,7 @@ void initialize_global_logger(
     FILE* file_stream,
     const char* file_path
 ) {
-    global_logger.log_level = log_level;
+    logger_set_level(&global_logger, log_level);
     global_logger.log_type = log_type;
     global_logger.log_type_name = log_type_name;
     global_logger.file_stream = file_stream;
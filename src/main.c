@@ -1,8 +1,22 @@
 #include "logger.h"
 #include "viewport.h"
 #include "shaders.h"
+#include "profile.h"
+#include "startup.h"
+#include "watch.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Minimum time between two log messages from a high-frequency input event
+#define IMSDL_INPUT_LOG_INTERVAL_MS 250
+
+// Programs built at startup: triangles, then instanced rects
+static const char* const imsdl_programs[][2] = {
+    {"vertex.glsl", "fragment.glsl"},
+    {"rect_vertex.glsl", "rect_fragment.glsl"},
+};
 
 // Don't over complicate this, keep this simple for now
 typedef struct IMSDL_Mouse_State {
@@ -18,67 +32,252 @@ typedef struct IMSDL_Mouse_State {
     int active;
 } IMSDL_Mouse_State;
 
-int main(void) {
-    IMSDL_Viewport* viewport = imsdl_create_viewport("IMSDL", 800, 600, 0);
+/**
+ * @brief Write out queued log messages when the process exits.
+ */
+static void imsdl_stop_logger(void) {
+    logger_stop_async(&global_logger);
+}
+
+/**
+ * @brief Wake the idle event loop so changed shaders get picked up.
+ *
+ * Runs on the shader watch thread; SDL_PushEvent is thread-safe.
+ */
+static void imsdl_wake(void* user_data) {
+    (void) user_data;
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = SDL_USEREVENT;
+    SDL_PushEvent(&event);
+}
+
+/**
+ * @brief Track mouse input; returns true if the frame needs redrawing.
+ */
+static bool imsdl_handle_mouse(const SDL_Event* event, void* user_data) {
+    IMSDL_Mouse_State* mouse = (IMSDL_Mouse_State*) user_data;
+    switch (event->type) {
+        case SDL_MOUSEMOTION:
+            mouse->x = event->motion.x;
+            mouse->y = event->motion.y;
+            LOG_INFO_RATELIMIT(
+                IMSDL_INPUT_LOG_INTERVAL_MS, "Mouse: x=%d, y=%d", mouse->x, mouse->y
+            );
+            return true;
+        case SDL_MOUSEBUTTONDOWN:
+            if (event->button.button == SDL_BUTTON_LEFT) {
+                mouse->left_down = 1;
+                LOG_INFO("Mouse left down.");
+            }
+            if (event->button.button == SDL_BUTTON_RIGHT) {
+                mouse->right_down = 1;
+                LOG_INFO("Mouse right down.");
+            }
+            return true;
+        case SDL_MOUSEBUTTONUP:
+            if (event->button.button == SDL_BUTTON_LEFT) {
+                mouse->left_up = 1;
+                LOG_INFO("Mouse left up.");
+            }
+            if (event->button.button == SDL_BUTTON_RIGHT) {
+                mouse->right_up = 1;
+                LOG_INFO("Mouse right up.");
+            }
+            return true;
+        case SDL_MOUSEWHEEL:
+            // Nothing scrolls yet, so the frame is unchanged
+            if (event->wheel.y > 0) {
+                LOG_INFO_RATELIMIT(IMSDL_INPUT_LOG_INTERVAL_MS, "Scrolling up.");
+            } else {
+                LOG_INFO_RATELIMIT(IMSDL_INPUT_LOG_INTERVAL_MS, "Scrolling down.");
+            }
+            return false;
+    }
+    return false;
+}
+
+/**
+ * @brief Record the demo frame: a centered panel and a marker under the cursor.
+ */
+static void imsdl_draw_scene(IMSDL_Viewport* viewport, const IMSDL_Mouse_State* mouse) {
+    IMSDL_DrawList* draw = viewport->draw;
+    float width = (float) viewport->view.width;
+    float height = (float) viewport->view.height;
+    IMSDL_Vec2 min = {width * 0.25f, height * 0.25f};
+    IMSDL_Vec2 max = {width * 0.75f, height * 0.75f};
+    imsdl_draw_rounded_rect(
+        draw,
+        min,
+        max,
+        12.0f,
+        IMSDL_RGBA(255, 255, 255, 255),
+        2.0f,
+        IMSDL_RGBA(64, 128, 255, 255)
+    );
+    imsdl_draw_rect_filled(
+        draw,
+        (IMSDL_Vec2) {mouse->x - 4.0f, mouse->y - 4.0f},
+        (IMSDL_Vec2) {mouse->x + 4.0f, mouse->y + 4.0f},
+        IMSDL_RGBA(255, 64, 64, 255)
+    );
+}
+
+/**
+ * @brief Render one frame offscreen and write it to path as a PPM image.
+ */
+static bool imsdl_render_to_file(
+    IMSDL_Viewport* viewport, GLuint shader_program, GLuint rect_program, const char* path
+) {
+    IMSDL_Mouse_State mouse = {0};
+    mouse.x = viewport->view.width / 2;
+    mouse.y = viewport->view.height / 2;
+    imsdl_draw_scene(viewport, &mouse);
+    imsdl_request_capture(viewport);
+    imsdl_render(viewport, shader_program, rect_program);
+
+    size_t size = (size_t) viewport->view.width * (size_t) viewport->view.height * 4;
+    uint8_t* pixels = (uint8_t*) malloc(size);
+    if (!pixels) {
+        LOG_ERROR("Failed to allocate memory for captured frame.");
+        return false;
+    }
+
+    int width, height;
+    bool ok = imsdl_capture_read(viewport->gl.capture, pixels, size, &width, &height, true)
+              && imsdl_capture_write_ppm(path, pixels, width, height);
+    if (ok) {
+        LOG_INFO("Wrote %dx%d frame to %s", width, height, path);
+    }
+    free(pixels);
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    // Keep log I/O off the render thread
+    uint64_t start = profile_now_ns();
+    if (logger_start_async(&global_logger, 4096, LOG_OVERFLOW_DROP)) {
+        atexit(imsdl_stop_logger);
+        logger_install_crash_handler(&global_logger);
+    }
+    imsdl_startup_record("logger", start);
+
+    // --headless <output.ppm> renders a single frame without a display;
+    // --software rasterizes on the CPU for machines without usable GL
+    const char* headless_output = NULL;
+    bool software = false;
+    if (argc == 3 && strcmp(argv[1], "--headless") == 0) {
+        headless_output = argv[2];
+    } else if (argc == 2 && strcmp(argv[1], "--software") == 0) {
+        software = true;
+    } else if (argc != 1) {
+        fprintf(stderr, "Usage: %s [--headless <output.ppm> | --software]\n", argv[0]);
+        return 1;
+    }
+
+    // Shader sources are prepared on a worker while SDL and GL initialize;
+    // the software backend has no GL context to build programs in
+    IMSDL_StartupShaders startup_shaders;
+    if (!software) {
+        imsdl_startup_shaders_begin(
+            &startup_shaders, imsdl_programs, sizeof(imsdl_programs) / sizeof(imsdl_programs[0])
+        );
+    }
+
+    IMSDL_Viewport* viewport = NULL;
+    if (headless_output) {
+        viewport = imsdl_create_headless_viewport("IMSDL", 800, 600);
+    } else if (software) {
+        viewport = imsdl_create_software_viewport("IMSDL", 800, 600, 0);
+    } else {
+        viewport = imsdl_create_viewport("IMSDL", 800, 600, 0);
+    }
     if (!viewport) {
         LOG_ERROR("Failed to create viewport!");
+        if (!software) {
+            imsdl_startup_shaders_end(&startup_shaders, NULL);
+        }
         return 1;
     }
-    imsdl_log_sdl_and_opengl();
     imsdl_log_viewport(viewport);
 
-    float vertices[] = {-0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f};
-    imsdl_init_opengl_vertex_buffer(viewport, vertices, sizeof(vertices));
+    GLuint programs[2] = {0, 0};
+    if (!software) {
+        imsdl_log_sdl_and_opengl();
+        imsdl_startup_shaders_end(&startup_shaders, programs);
+    }
+    GLuint shader_program = programs[0];
+    GLuint rect_program = programs[1];
 
-    GLuint shader_program
-        = imsdl_create_shader_program("shaders/vertex.glsl", "shaders/fragment.glsl");
+    if (headless_output) {
+        start = profile_now_ns();
+        bool ok = imsdl_render_to_file(viewport, shader_program, rect_program, headless_output);
+        imsdl_startup_record("first_frame", start);
+        imsdl_startup_log();
+        imsdl_destroy_viewport(viewport);
+        return ok ? 0 : 1;
+    }
+
+    // Setting IMSDL_SHADER_DIR also rebuilds programs while their files are edited
+    IMSDL_ShaderWatch* watch = NULL;
+    const char* shader_dir = getenv(IMSDL_SHADER_DIR_ENV);
+    if (!software && shader_dir && *shader_dir) {
+        watch = imsdl_shader_watch_create(shader_dir, imsdl_wake, NULL);
+        if (watch) {
+            imsdl_shader_watch_add(watch, &shader_program, "vertex.glsl", "fragment.glsl");
+            imsdl_shader_watch_add(watch, &rect_program, "rect_vertex.glsl", "rect_fragment.glsl");
+        }
+    }
 
     IMSDL_Mouse_State mouse = {0};
     mouse.x = mouse.y = 0;
     int running = 1;
+    bool started = false;
     while (running) {
-        SDL_Event event;
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_QUIT:
-                    running = 0;
-                    break;
-                case SDL_MOUSEMOTION:
-                    mouse.x = event.motion.x;
-                    mouse.y = event.motion.y;
-                    LOG_INFO("Mouse: x=%d, y=%d", mouse.x, mouse.y);
-                    break;
-                case SDL_MOUSEBUTTONDOWN:
-                    if (event.button.button == SDL_BUTTON_LEFT) {
-                        mouse.left_down = 1;
-                        LOG_INFO("Mouse left down.");
-                    }
-                    if (event.button.button == SDL_BUTTON_RIGHT) {
-                        mouse.right_down = 1;
-                        LOG_INFO("Mouse right down.");
-                    }
-                    break;
-                case SDL_MOUSEBUTTONUP:
-                    if (event.button.button == SDL_BUTTON_LEFT) {
-                        mouse.left_up = 1;
-                        LOG_INFO("Mouse left up.");
-                    }
-                    if (event.button.button == SDL_BUTTON_RIGHT) {
-                        mouse.right_up = 1;
-                        LOG_INFO("Mouse right up.");
-                    }
-                    break;
-                case SDL_MOUSEWHEEL:
-                    if (event.wheel.y > 0) {
-                        LOG_INFO("Scrolling up.");
-                    } else {
-                        LOG_INFO("Scrolling down.");
-                    }
+        // Swapped programs invalidate the cached binding; keep polling until builds finish
+        if (watch) {
+            if (imsdl_shader_watch_poll(watch)) {
+                imsdl_gl_invalidate(viewport);
+                imsdl_request_redraw(viewport);
+            }
+            if (imsdl_shader_watch_busy(watch)) {
+                imsdl_request_redraw_in(viewport, 16);
             }
         }
-        imsdl_render(viewport, shader_program);
+
+        // Sleeps while idle; only input that changes the frame wakes the renderer
+        if (!imsdl_handle_events(viewport, &running, imsdl_handle_mouse, &mouse)) {
+            continue;
+        }
+
+        start = profile_now_ns();
+        PROFILE_ZONE_BEGIN(build);
+        imsdl_draw_scene(viewport, &mouse);
+        PROFILE_ZONE_END(build);
+        imsdl_render(viewport, shader_program, rect_program);
+
+        // Time to first frame covers everything from the top of main
+        if (!started) {
+            imsdl_startup_record("first_frame", start);
+            imsdl_startup_log();
+            started = true;
+        }
+    }
+
+    if (!software) {
+        imsdl_log_gl_state(viewport);
     }
 
+#ifdef IMSDL_PROFILE
+    profile_log();
+#endif
+
+#ifdef IMSDL_MEMSTAT
+    memstat_log();
+    memstat_log_sites();
+#endif
+
+    imsdl_shader_watch_free(watch);
     imsdl_destroy_viewport(viewport);
     return 0;
 }
@@ -0,0 +1,205 @@
+/**
+ * @file src/memstat.c
+ * @brief Optional allocator statistics and high-water-mark instrumentation.
+ */
+
+#include "logger.h"
+#include "memstat.h"
+
+#include <stdint.h>
+
+/**
+ * @brief A slot in the call site table, keyed by file pointer and line.
+ */
+typedef struct MemStatSiteEntry {
+    const char* file;
+    int line;
+    size_t alloc_count;
+    size_t alloc_bytes;
+} MemStatSiteEntry;
+
+MemStat memstat_aligned = {"aligned_malloc", 0, 0, 0, 0, 0, 0, 0, 0, NULL};
+
+// Registered allocators, starting with the global aligned allocator
+static MemStat* memstat_head = &memstat_aligned;
+static pthread_mutex_t memstat_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Open addressing table of call sites; __FILE__ literals are compared by pointer
+static MemStatSiteEntry memstat_site_table[MEMSTAT_SITE_COUNT];
+static size_t memstat_site_dropped = 0;
+static pthread_mutex_t memstat_site_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void memstat_register(MemStat* stat, const char* name) {
+    stat->name = name;
+    atomic_init(&stat->live_bytes, 0);
+    atomic_init(&stat->peak_bytes, 0);
+    atomic_init(&stat->alloc_count, 0);
+    atomic_init(&stat->free_count, 0);
+    atomic_init(&stat->frame_allocs, 0);
+    atomic_init(&stat->frame_bytes, 0);
+    atomic_init(&stat->last_frame_allocs, 0);
+    atomic_init(&stat->last_frame_bytes, 0);
+
+    pthread_mutex_lock(&memstat_lock);
+    stat->next = memstat_head;
+    memstat_head = stat;
+    pthread_mutex_unlock(&memstat_lock);
+}
+
+void memstat_unregister(MemStat* stat) {
+    pthread_mutex_lock(&memstat_lock);
+    for (MemStat** link = &memstat_head; *link; link = &(*link)->next) {
+        if (*link == stat) {
+            *link = stat->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&memstat_lock);
+}
+
+/**
+ * @brief Raise the peak if live has passed it.
+ */
+static void memstat_update_peak(MemStat* stat, size_t live) {
+    size_t peak = atomic_load_explicit(&stat->peak_bytes, memory_order_relaxed);
+    while (live > peak
+           && !atomic_compare_exchange_weak_explicit(
+               &stat->peak_bytes, &peak, live, memory_order_relaxed, memory_order_relaxed
+           )) {}
+}
+
+void memstat_alloc(MemStat* stat, size_t size) {
+    size_t live = atomic_fetch_add_explicit(&stat->live_bytes, size, memory_order_relaxed) + size;
+    memstat_update_peak(stat, live);
+    atomic_fetch_add_explicit(&stat->alloc_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stat->frame_allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stat->frame_bytes, size, memory_order_relaxed);
+}
+
+void memstat_free(MemStat* stat, size_t size) {
+    atomic_fetch_sub_explicit(&stat->live_bytes, size, memory_order_relaxed);
+    atomic_fetch_add_explicit(&stat->free_count, 1, memory_order_relaxed);
+}
+
+void memstat_set_live(MemStat* stat, size_t live_bytes) {
+    atomic_store_explicit(&stat->live_bytes, live_bytes, memory_order_relaxed);
+    memstat_update_peak(stat, live_bytes);
+}
+
+void* memstat_site(void* ptr, size_t size, const char* file, int line) {
+    if (ptr == NULL) {
+        return ptr;
+    }
+
+    size_t hash = ((uintptr_t) file >> 4) * 31u + (size_t) line;
+    pthread_mutex_lock(&memstat_site_lock);
+    for (size_t i = 0; i < MEMSTAT_SITE_COUNT; i++) {
+        MemStatSiteEntry* entry = &memstat_site_table[(hash + i) % MEMSTAT_SITE_COUNT];
+        if (entry->file == NULL) {
+            entry->file = file;
+            entry->line = line;
+        }
+        if (entry->file == file && entry->line == line) {
+            entry->alloc_count++;
+            entry->alloc_bytes += size;
+            pthread_mutex_unlock(&memstat_site_lock);
+            return ptr;
+        }
+    }
+    memstat_site_dropped++;
+    pthread_mutex_unlock(&memstat_site_lock);
+
+    return ptr;
+}
+
+void memstat_frame_end(void) {
+    pthread_mutex_lock(&memstat_lock);
+    for (MemStat* stat = memstat_head; stat; stat = stat->next) {
+        size_t allocs = atomic_exchange_explicit(&stat->frame_allocs, 0, memory_order_relaxed);
+        size_t bytes = atomic_exchange_explicit(&stat->frame_bytes, 0, memory_order_relaxed);
+        atomic_store_explicit(&stat->last_frame_allocs, allocs, memory_order_relaxed);
+        atomic_store_explicit(&stat->last_frame_bytes, bytes, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&memstat_lock);
+}
+
+void memstat_query(const MemStat* stat, MemStatInfo* info) {
+    info->name = stat->name;
+    info->live_bytes = atomic_load_explicit(&stat->live_bytes, memory_order_relaxed);
+    info->peak_bytes = atomic_load_explicit(&stat->peak_bytes, memory_order_relaxed);
+    info->alloc_count = atomic_load_explicit(&stat->alloc_count, memory_order_relaxed);
+    info->free_count = atomic_load_explicit(&stat->free_count, memory_order_relaxed);
+    info->last_frame_allocs = atomic_load_explicit(&stat->last_frame_allocs, memory_order_relaxed);
+    info->last_frame_bytes = atomic_load_explicit(&stat->last_frame_bytes, memory_order_relaxed);
+}
+
+void memstat_query_total(MemStatInfo* info) {
+    *info = (MemStatInfo) {"total", 0, 0, 0, 0, 0, 0};
+    pthread_mutex_lock(&memstat_lock);
+    for (MemStat* stat = memstat_head; stat; stat = stat->next) {
+        MemStatInfo part;
+        memstat_query(stat, &part);
+        info->live_bytes += part.live_bytes;
+        info->peak_bytes += part.peak_bytes;
+        info->alloc_count += part.alloc_count;
+        info->free_count += part.free_count;
+        info->last_frame_allocs += part.last_frame_allocs;
+        info->last_frame_bytes += part.last_frame_bytes;
+    }
+    pthread_mutex_unlock(&memstat_lock);
+}
+
+size_t memstat_sites(MemStatSite* sites, size_t max_sites) {
+    size_t count = 0;
+    pthread_mutex_lock(&memstat_site_lock);
+    for (size_t i = 0; i < MEMSTAT_SITE_COUNT && count < max_sites; i++) {
+        const MemStatSiteEntry* entry = &memstat_site_table[i];
+        if (entry->file) {
+            sites[count++] = (MemStatSite) {
+                entry->file, entry->line, entry->alloc_count, entry->alloc_bytes
+            };
+        }
+    }
+    pthread_mutex_unlock(&memstat_site_lock);
+    return count;
+}
+
+void memstat_log(void) {
+    pthread_mutex_lock(&memstat_lock);
+    for (MemStat* stat = memstat_head; stat; stat = stat->next) {
+        MemStatInfo info;
+        memstat_query(stat, &info);
+        LOG_INFO(
+            "%s: live=%zu peak=%zu allocs=%zu frees=%zu last_frame_allocs=%zu "
+            "last_frame_bytes=%zu",
+            info.name,
+            info.live_bytes,
+            info.peak_bytes,
+            info.alloc_count,
+            info.free_count,
+            info.last_frame_allocs,
+            info.last_frame_bytes
+        );
+    }
+    pthread_mutex_unlock(&memstat_lock);
+}
+
+void memstat_log_sites(void) {
+    pthread_mutex_lock(&memstat_site_lock);
+    for (size_t i = 0; i < MEMSTAT_SITE_COUNT; i++) {
+        const MemStatSiteEntry* entry = &memstat_site_table[i];
+        if (entry->file) {
+            LOG_INFO(
+                "%s:%d: allocs=%zu bytes=%zu",
+                entry->file,
+                entry->line,
+                entry->alloc_count,
+                entry->alloc_bytes
+            );
+        }
+    }
+    if (memstat_site_dropped) {
+        LOG_WARN("%zu allocations from untracked call sites.", memstat_site_dropped);
+    }
+    pthread_mutex_unlock(&memstat_site_lock);
+}
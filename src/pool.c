@@ -0,0 +1,147 @@
+/**
+ * @file src/pool.c
+ * @brief A fixed-size pool allocator with an intrusive free list.
+ */
+
+#include "logger.h"
+#include "align.h"
+#include "pool.h"
+#include "profile.h"
+
+#include <stdbool.h>
+
+/**
+ * @brief Size of the slab header rounded up so the first slot stays aligned.
+ */
+static size_t pool_header_size(const Pool* pool) {
+    return (sizeof(PoolSlab) + pool->alignment - 1) & ~(pool->alignment - 1);
+}
+
+/**
+ * @brief Allocate a new slab and make it the bump source for fresh slots.
+ */
+static bool pool_grow(Pool* pool) {
+    size_t header_size = pool_header_size(pool);
+    size_t slab_size = header_size + pool->slot_size * pool->slots_per_slab;
+
+    PoolSlab* slab = (PoolSlab*) aligned_malloc(pool->alignment, slab_size);
+    if (slab == NULL) {
+        LOG_ERROR("Failed to allocate memory for PoolSlab.");
+        return false;
+    }
+
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->cursor = (uint8_t*) slab + header_size;
+    pool->end = (uint8_t*) slab + slab_size;
+
+    return true;
+}
+
+Pool* pool_create(size_t slot_size, size_t slots_per_slab, size_t alignment) {
+    // Ensure valid input
+    if (slot_size == 0) {
+        LOG_ERROR("Invalid slot size, must be greater than 0.");
+        return NULL;
+    }
+    if (slots_per_slab == 0) {
+        LOG_ERROR("Invalid slots per slab, must be greater than 0.");
+        return NULL;
+    }
+
+    // Ensure alignment is at least sizeof(void*) and a power of 2
+    if (alignment == 0) {
+        alignment = POOL_CACHE_LINE;
+    }
+    if (alignment < sizeof(void*)) {
+        alignment = sizeof(void*);
+    }
+    if ((alignment & (alignment - 1)) != 0) {
+        LOG_ERROR("Alignment %zu is not a power of 2.", alignment);
+        return NULL;
+    }
+
+    // Each slot must hold a free list link and keep its neighbours aligned
+    if (slot_size < sizeof(void*)) {
+        slot_size = sizeof(void*);
+    }
+    if (slot_size > SIZE_MAX - alignment) {
+        LOG_ERROR("Slot size %zu overflows.", slot_size);
+        return NULL;
+    }
+    slot_size = (slot_size + alignment - 1) & ~(alignment - 1);
+    if (slots_per_slab > (SIZE_MAX - alignment) / slot_size) {
+        LOG_ERROR(
+            "Pool slab size overflows (slot_size=%zu, slots_per_slab=%zu).",
+            slot_size,
+            slots_per_slab
+        );
+        return NULL;
+    }
+
+    // Allocate memory for the pool structure
+    Pool* pool = (Pool*) malloc(sizeof(Pool));
+    if (pool == NULL) {
+        LOG_ERROR("Failed to allocate memory for Pool.");
+        return NULL;
+    }
+
+    // Initialize pool fields; the first slab is allocated on first acquire
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->cursor = NULL;
+    pool->end = NULL;
+    pool->slot_size = slot_size;
+    pool->alignment = alignment;
+    pool->slots_per_slab = slots_per_slab;
+    pool->count = 0;
+    MEMSTAT_REGISTER(&pool->stat, "pool");
+
+    return pool;
+}
+
+void pool_free(Pool* pool) {
+    if (pool) {
+        MEMSTAT_UNREGISTER(&pool->stat);
+        PoolSlab* slab = pool->slabs;
+        while (slab) {
+            PoolSlab* next = slab->next;
+            aligned_free(slab);
+            slab = next;
+        }
+        free(pool);
+    }
+}
+
+void*(pool_acquire)(Pool* pool) {
+    // Prefer recently released slots; they are likely still in cache
+    void* slot = pool->free_list;
+    if (slot) {
+        pool->free_list = *(void**) slot;
+        pool->count++;
+        MEMSTAT_ALLOC(&pool->stat, pool->slot_size);
+        PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 1);
+        return slot;
+    }
+
+    // Bump from the newest slab, growing when it is exhausted
+    if (pool->cursor == pool->end && !pool_grow(pool)) {
+        return NULL;
+    }
+
+    slot = pool->cursor;
+    pool->cursor += pool->slot_size;
+    pool->count++;
+    MEMSTAT_ALLOC(&pool->stat, pool->slot_size);
+    PROFILE_COUNT(PROFILE_COUNTER_ALLOCATIONS, 1);
+    return slot;
+}
+
+void pool_release(Pool* pool, void* slot) {
+    if (slot) {
+        *(void**) slot = pool->free_list;
+        pool->free_list = slot;
+        pool->count--;
+        MEMSTAT_FREE(&pool->stat, pool->slot_size);
+    }
+}
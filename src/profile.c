@@ -0,0 +1,235 @@
+/**
+ * @file src/profile.c
+ * @brief Optional frame timing: CPU zones, GPU timer queries and counters.
+ */
+
+#include "logger.h"
+#include "profile.h"
+
+#include <GL/glew.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * @brief A ring of the most recent frame times in nanoseconds.
+ */
+typedef struct ProfileHistory {
+    uint64_t samples[PROFILE_HISTORY];
+    size_t next; // Slot written by the next sample
+    size_t count; // Valid samples, up to PROFILE_HISTORY
+} ProfileHistory;
+
+static ProfileZone profile_zone_table[PROFILE_ZONE_COUNT];
+static size_t profile_zone_count = 0;
+
+static _Atomic uint64_t profile_counters[PROFILE_COUNTER_COUNT];
+static uint64_t profile_last_counters[PROFILE_COUNTER_COUNT];
+
+static ProfileHistory profile_cpu;
+static ProfileHistory profile_gpu;
+static uint64_t profile_frames = 0;
+static uint64_t profile_frame_start = 0; // 0 until the first frame begins or ends
+
+// GL_TIME_ELAPSED queries used round-robin, one per frame in flight
+static GLuint profile_queries[PROFILE_GPU_LATENCY];
+static bool profile_query_pending[PROFILE_GPU_LATENCY];
+static uint32_t profile_query_next = 0;
+static bool profile_query_active = false;
+
+static void profile_history_push(ProfileHistory* history, uint64_t sample) {
+    history->samples[history->next] = sample;
+    history->next = (history->next + 1) % PROFILE_HISTORY;
+    if (history->count < PROFILE_HISTORY) {
+        history->count++;
+    }
+}
+
+static int profile_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Computes nearest-rank percentiles of a history in milliseconds.
+ */
+static void profile_history_percentiles(
+    const ProfileHistory* history, double* p50, double* p99, double* max
+) {
+    *p50 = *p99 = *max = 0.0;
+    if (history->count == 0) {
+        return;
+    }
+
+    // Sort a copy so recording stays O(1); queries are rare
+    uint64_t sorted[PROFILE_HISTORY];
+    memcpy(sorted, history->samples, history->count * sizeof(uint64_t));
+    qsort(sorted, history->count, sizeof(uint64_t), profile_compare);
+
+    size_t n = history->count;
+    *p50 = (double) sorted[(n * 50 + 99) / 100 - 1] / 1e6;
+    *p99 = (double) sorted[(n * 99 + 99) / 100 - 1] / 1e6;
+    *max = (double) sorted[n - 1] / 1e6;
+}
+
+uint64_t profile_now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000ull + (uint64_t) now.tv_nsec;
+}
+
+uint64_t profile_zone_begin(ProfileZone** zone, const char* name) {
+    if (!*zone) {
+        if (profile_zone_count == PROFILE_ZONE_COUNT) {
+            LOG_WARN("Profile zone table full, dropping zone %s.", name);
+            static ProfileZone overflow = {"overflow", 0, 0, 0, 0};
+            *zone = &overflow;
+        } else {
+            *zone = &profile_zone_table[profile_zone_count++];
+            (*zone)->name = name;
+        }
+    }
+    return profile_now_ns();
+}
+
+void profile_zone_end(ProfileZone* zone, uint64_t start) {
+    uint64_t elapsed = profile_now_ns() - start;
+    zone->frame_ns += elapsed;
+    zone->total_ns += elapsed;
+    zone->calls++;
+}
+
+void profile_count(ProfileCounter counter, uint64_t amount) {
+    atomic_fetch_add_explicit(&profile_counters[counter], amount, memory_order_relaxed);
+}
+
+void profile_frame_begin(void) {
+    profile_frame_start = profile_now_ns();
+}
+
+void profile_frame_end(void) {
+    uint64_t now = profile_now_ns();
+    if (profile_frame_start != 0) {
+        profile_history_push(&profile_cpu, now - profile_frame_start);
+    }
+    profile_frame_start = now;
+    profile_frames++;
+
+    for (size_t i = 0; i < profile_zone_count; i++) {
+        profile_zone_table[i].last_frame_ns = profile_zone_table[i].frame_ns;
+        profile_zone_table[i].frame_ns = 0;
+    }
+    for (int i = 0; i < PROFILE_COUNTER_COUNT; i++) {
+        profile_last_counters[i]
+            = atomic_exchange_explicit(&profile_counters[i], 0, memory_order_relaxed);
+    }
+}
+
+void profile_gpu_begin(void) {
+    if (!profile_queries[0]) {
+        glGenQueries(PROFILE_GPU_LATENCY, profile_queries);
+    }
+
+    // Collect the result from PROFILE_GPU_LATENCY frames ago, but never wait for it
+    uint32_t slot = profile_query_next;
+    GLuint query = profile_queries[slot];
+    if (profile_query_pending[slot]) {
+        GLint available = 0;
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return;
+        }
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        profile_history_push(&profile_gpu, (uint64_t) elapsed);
+        profile_query_pending[slot] = false;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, query);
+    profile_query_active = true;
+}
+
+void profile_gpu_end(void) {
+    if (!profile_query_active) {
+        return;
+    }
+
+    glEndQuery(GL_TIME_ELAPSED);
+    profile_query_active = false;
+    profile_query_pending[profile_query_next] = true;
+    profile_query_next = (profile_query_next + 1) % PROFILE_GPU_LATENCY;
+}
+
+void profile_gpu_shutdown(void) {
+    if (profile_queries[0]) {
+        glDeleteQueries(PROFILE_GPU_LATENCY, profile_queries);
+        memset(profile_queries, 0, sizeof(profile_queries));
+        memset(profile_query_pending, 0, sizeof(profile_query_pending));
+        profile_query_next = 0;
+    }
+}
+
+void profile_query(ProfileStats* stats) {
+    stats->frames = profile_frames;
+    stats->cpu_samples = profile_cpu.count;
+    profile_history_percentiles(
+        &profile_cpu, &stats->cpu_p50_ms, &stats->cpu_p99_ms, &stats->cpu_max_ms
+    );
+    stats->gpu_samples = profile_gpu.count;
+    profile_history_percentiles(
+        &profile_gpu, &stats->gpu_p50_ms, &stats->gpu_p99_ms, &stats->gpu_max_ms
+    );
+    memcpy(stats->counters, profile_last_counters, sizeof(stats->counters));
+}
+
+size_t profile_zones(ProfileZone* zones, size_t max_zones) {
+    size_t count = profile_zone_count < max_zones ? profile_zone_count : max_zones;
+    memcpy(zones, profile_zone_table, count * sizeof(ProfileZone));
+    return count;
+}
+
+void profile_log(void) {
+    ProfileStats stats;
+    profile_query(&stats);
+
+    LOG_INFO(
+        "Frames: %llu, CPU p50=%.3fms p99=%.3fms max=%.3fms over %zu frames",
+        (unsigned long long) stats.frames,
+        stats.cpu_p50_ms,
+        stats.cpu_p99_ms,
+        stats.cpu_max_ms,
+        stats.cpu_samples
+    );
+    if (stats.gpu_samples > 0) {
+        LOG_INFO(
+            "GPU p50=%.3fms p99=%.3fms max=%.3fms over %zu frames",
+            stats.gpu_p50_ms,
+            stats.gpu_p99_ms,
+            stats.gpu_max_ms,
+            stats.gpu_samples
+        );
+    }
+    LOG_INFO(
+        "Last frame: draw_calls=%llu vertices=%llu indices=%llu rects=%llu allocations=%llu",
+        (unsigned long long) stats.counters[PROFILE_COUNTER_DRAW_CALLS],
+        (unsigned long long) stats.counters[PROFILE_COUNTER_VERTICES],
+        (unsigned long long) stats.counters[PROFILE_COUNTER_INDICES],
+        (unsigned long long) stats.counters[PROFILE_COUNTER_RECTS],
+        (unsigned long long) stats.counters[PROFILE_COUNTER_ALLOCATIONS]
+    );
+
+    for (size_t i = 0; i < profile_zone_count; i++) {
+        const ProfileZone* zone = &profile_zone_table[i];
+        LOG_INFO(
+            "Zone %s: calls=%llu avg=%.3fms last_frame=%.3fms",
+            zone->name,
+            (unsigned long long) zone->calls,
+            zone->calls ? (double) zone->total_ns / (double) zone->calls / 1e6 : 0.0,
+            (double) zone->last_frame_ns / 1e6
+        );
+    }
+}
@@ -0,0 +1,758 @@
+/**
+ * @file src/raster.c
+ * @brief CPU rasterizer for the draw list.
+ */
+
+#include "logger.h"
+#include "raster.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define IMSDL_RASTER_X86
+    #include <immintrin.h>
+#endif
+
+// Marks a bin entry as the first index of a triangle rather than a rect index
+#define IMSDL_RASTER_TRIANGLE 0x80000000u
+
+/**
+ * @brief Swaps the R and B bytes of a packed color when the target wants BGRA.
+ */
+static uint32_t imsdl_raster_swizzle(uint32_t color, bool swap_rb) {
+    if (!swap_rb) {
+        return color;
+    }
+    return (color & 0xFF00FF00u) | ((color & 0xFFu) << 16) | ((color >> 16) & 0xFFu);
+}
+
+static float imsdl_raster_clamp01(float value) {
+    return fminf(fmaxf(value, 0.0f), 1.0f);
+}
+
+/**
+ * @brief Clamps a finite pixel coordinate to [low, high] before converting it.
+ *
+ * Clamping in float keeps the cast defined for coordinates far outside int range.
+ */
+static int imsdl_raster_clamp_pixel(float value, int low, int high) {
+    return (int) fminf(fmaxf(value, (float) low), (float) high);
+}
+
+// --- Rect Kernels ---
+
+/**
+ * @brief Shades one pixel of a rect over dst; mirrors shaders/rect_fragment.glsl.
+ *
+ * The distance is in pixels, so the shader's fwidth() is 1 here.
+ */
+static uint32_t imsdl_raster_shade(
+    const IMSDL_RasterRect* rect, float px, float qy, float qy_sq, uint32_t dst
+) {
+    float qx = fabsf(px - rect->cx) - rect->hx + rect->radius;
+    float mx = fmaxf(qx, 0.0f);
+    float d = sqrtf(mx * mx + qy_sq) + fminf(fmaxf(qx, qy), 0.0f) - rect->radius;
+    float outer = imsdl_raster_clamp01(0.5f - d);
+    float inner = imsdl_raster_clamp01(0.5f - d - rect->border);
+
+    float alpha = (rect->edge[3] + (rect->fill[3] - rect->edge[3]) * inner) * outer;
+    float inverse = 1.0f - alpha * (1.0f / 255.0f);
+
+    uint32_t out = 0;
+    for (int c = 0; c < 4; c++) {
+        float source = (rect->edge[c] + (rect->fill[c] - rect->edge[c]) * inner) * outer;
+        float value = source + (float) ((dst >> (c * 8)) & 0xFF) * inverse;
+        out |= (uint32_t) lrintf(value) << (c * 8);
+    }
+    return out;
+}
+
+static void imsdl_raster_span_scalar(
+    uint32_t* row, int count, int x, int y, const IMSDL_RasterRect* rect
+) {
+    float qy = fabsf((float) y + 0.5f - rect->cy) - rect->hy + rect->radius;
+    float qy_sq = fmaxf(qy, 0.0f) * fmaxf(qy, 0.0f);
+    for (int i = 0; i < count; i++) {
+        row[i] = imsdl_raster_shade(rect, (float) (x + i) + 0.5f, qy, qy_sq, row[i]);
+    }
+}
+
+#ifdef IMSDL_RASTER_X86
+
+/**
+ * @brief Shades four pixels at a time; the remainder falls back to scalar.
+ */
+__attribute__((target("sse2"))) static void imsdl_raster_span_sse2(
+    uint32_t* row, int count, int x, int y, const IMSDL_RasterRect* rect
+) {
+    float qy_s = fabsf((float) y + 0.5f - rect->cy) - rect->hy + rect->radius;
+    const __m128 qy = _mm_set1_ps(qy_s);
+    const __m128 qy_sq = _mm_set1_ps(fmaxf(qy_s, 0.0f) * fmaxf(qy_s, 0.0f));
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 cx = _mm_set1_ps(rect->cx);
+    const __m128 offset = _mm_set1_ps(rect->radius - rect->hx);
+    const __m128 radius = _mm_set1_ps(rect->radius);
+    const __m128 border = _mm_set1_ps(rect->border);
+    const __m128 scale = _mm_set1_ps(1.0f / 255.0f);
+    const __m128i mask = _mm_set1_epi32(0xFF);
+
+    __m128 edge[4], delta[4];
+    for (int c = 0; c < 4; c++) {
+        edge[c] = _mm_set1_ps(rect->edge[c]);
+        delta[c] = _mm_set1_ps(rect->fill[c] - rect->edge[c]);
+    }
+
+    __m128 px = _mm_add_ps(_mm_set1_ps((float) x + 0.5f), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 qx = _mm_add_ps(_mm_andnot_ps(sign, _mm_sub_ps(px, cx)), offset);
+        __m128 mx = _mm_max_ps(qx, zero);
+        __m128 d = _mm_add_ps(
+            _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(mx, mx), qy_sq)),
+            _mm_sub_ps(_mm_min_ps(_mm_max_ps(qx, qy), zero), radius)
+        );
+        __m128 outer = _mm_min_ps(_mm_max_ps(_mm_sub_ps(half, d), zero), one);
+        __m128 inner = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_sub_ps(half, d), border), zero), one);
+
+        __m128i dst = _mm_loadu_si128((const __m128i*) (row + i));
+        __m128 alpha = _mm_mul_ps(_mm_add_ps(edge[3], _mm_mul_ps(delta[3], inner)), outer);
+        __m128 inverse = _mm_sub_ps(one, _mm_mul_ps(alpha, scale));
+
+        __m128i out = _mm_setzero_si128();
+        for (int c = 0; c < 4; c++) {
+            __m128 source = _mm_mul_ps(_mm_add_ps(edge[c], _mm_mul_ps(delta[c], inner)), outer);
+            __m128 channel = _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(dst, c * 8), mask));
+            __m128i value = _mm_cvtps_epi32(_mm_add_ps(source, _mm_mul_ps(channel, inverse)));
+            out = _mm_or_si128(out, _mm_slli_epi32(value, c * 8));
+        }
+        _mm_storeu_si128((__m128i*) (row + i), out);
+        px = _mm_add_ps(px, _mm_set1_ps(4.0f));
+    }
+
+    if (i < count) {
+        imsdl_raster_span_scalar(row + i, count - i, x + i, y, rect);
+    }
+}
+
+/**
+ * @brief Shades eight pixels at a time; the remainder falls back to SSE2.
+ */
+__attribute__((target("avx2"))) static void imsdl_raster_span_avx2(
+    uint32_t* row, int count, int x, int y, const IMSDL_RasterRect* rect
+) {
+    float qy_s = fabsf((float) y + 0.5f - rect->cy) - rect->hy + rect->radius;
+    const __m256 qy = _mm256_set1_ps(qy_s);
+    const __m256 qy_sq = _mm256_set1_ps(fmaxf(qy_s, 0.0f) * fmaxf(qy_s, 0.0f));
+    const __m256 sign = _mm256_set1_ps(-0.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 cx = _mm256_set1_ps(rect->cx);
+    const __m256 offset = _mm256_set1_ps(rect->radius - rect->hx);
+    const __m256 radius = _mm256_set1_ps(rect->radius);
+    const __m256 border = _mm256_set1_ps(rect->border);
+    const __m256 scale = _mm256_set1_ps(1.0f / 255.0f);
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+
+    __m256 edge[4], delta[4];
+    for (int c = 0; c < 4; c++) {
+        edge[c] = _mm256_set1_ps(rect->edge[c]);
+        delta[c] = _mm256_set1_ps(rect->fill[c] - rect->edge[c]);
+    }
+
+    __m256 px = _mm256_add_ps(
+        _mm256_set1_ps((float) x + 0.5f),
+        _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f)
+    );
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 qx = _mm256_add_ps(_mm256_andnot_ps(sign, _mm256_sub_ps(px, cx)), offset);
+        __m256 mx = _mm256_max_ps(qx, zero);
+        __m256 d = _mm256_add_ps(
+            _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(mx, mx), qy_sq)),
+            _mm256_sub_ps(_mm256_min_ps(_mm256_max_ps(qx, qy), zero), radius)
+        );
+        __m256 outer = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(half, d), zero), one);
+        __m256 inner = _mm256_min_ps(
+            _mm256_max_ps(_mm256_sub_ps(_mm256_sub_ps(half, d), border), zero), one
+        );
+
+        __m256i dst = _mm256_loadu_si256((const __m256i*) (row + i));
+        __m256 alpha = _mm256_mul_ps(_mm256_add_ps(edge[3], _mm256_mul_ps(delta[3], inner)), outer);
+        __m256 inverse = _mm256_sub_ps(one, _mm256_mul_ps(alpha, scale));
+
+        __m256i out = _mm256_setzero_si256();
+        for (int c = 0; c < 4; c++) {
+            __m256 source
+                = _mm256_mul_ps(_mm256_add_ps(edge[c], _mm256_mul_ps(delta[c], inner)), outer);
+            __m256 channel
+                = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(dst, c * 8), mask));
+            __m256i value
+                = _mm256_cvtps_epi32(_mm256_add_ps(source, _mm256_mul_ps(channel, inverse)));
+            out = _mm256_or_si256(out, _mm256_slli_epi32(value, c * 8));
+        }
+        _mm256_storeu_si256((__m256i*) (row + i), out);
+        px = _mm256_add_ps(px, _mm256_set1_ps(8.0f));
+    }
+
+    if (i < count) {
+        imsdl_raster_span_sse2(row + i, count - i, x + i, y, rect);
+    }
+}
+
+#endif // IMSDL_RASTER_X86
+
+// --- Primitive Setup ---
+
+/**
+ * @brief Prepares a rect instance for shading.
+ *
+ * @return False if the rect touches no pixel of the target.
+ */
+static bool imsdl_raster_setup_rect(
+    const IMSDL_Raster* raster, const IMSDL_RectInstance* instance, IMSDL_RasterRect* rect
+) {
+    float min_x = fminf(instance->x0, instance->x1);
+    float max_x = fmaxf(instance->x0, instance->x1);
+    float min_y = fminf(instance->y0, instance->y1);
+    float max_y = fmaxf(instance->y0, instance->y1);
+    if (!isfinite(min_x) || !isfinite(max_x) || !isfinite(min_y) || !isfinite(max_y)) {
+        return false;
+    }
+
+    rect->cx = (min_x + max_x) * 0.5f;
+    rect->cy = (min_y + max_y) * 0.5f;
+    rect->hx = (max_x - min_x) * 0.5f;
+    rect->hy = (max_y - min_y) * 0.5f;
+    rect->radius = fmaxf(fminf(instance->radius, fminf(rect->hx, rect->hy)), 0.0f);
+    rect->border = instance->border;
+
+    // Premultiply once here rather than per pixel
+    uint32_t fill = imsdl_raster_swizzle(instance->fill, raster->swap_rb);
+    uint32_t edge = fill;
+    if (rect->border > 0.0f) {
+        edge = imsdl_raster_swizzle(instance->border_color, raster->swap_rb);
+    }
+    float fill_alpha = (float) (fill >> 24) / 255.0f;
+    float edge_alpha = (float) (edge >> 24) / 255.0f;
+    for (int c = 0; c < 3; c++) {
+        rect->fill[c] = (float) ((fill >> (c * 8)) & 0xFF) * fill_alpha;
+        rect->edge[c] = (float) ((edge >> (c * 8)) & 0xFF) * edge_alpha;
+    }
+    rect->fill[3] = (float) (fill >> 24);
+    rect->edge[3] = (float) (edge >> 24);
+
+    // Same one pixel of padding the vertex shader adds for the anti-aliased edge
+    rect->x0 = imsdl_raster_clamp_pixel(floorf(min_x - 1.0f), 0, raster->width);
+    rect->y0 = imsdl_raster_clamp_pixel(floorf(min_y - 1.0f), 0, raster->height);
+    rect->x1 = imsdl_raster_clamp_pixel(ceilf(max_x + 1.0f), 0, raster->width);
+    rect->y1 = imsdl_raster_clamp_pixel(ceilf(max_y + 1.0f), 0, raster->height);
+    if (rect->x0 >= rect->x1 || rect->y0 >= rect->y1) {
+        return false;
+    }
+
+    // Pixels whose centers are at least this far inside have full coverage of the fill
+    float inset = fmaxf(rect->radius, 0.5f + fmaxf(rect->border, 0.0f));
+    float extent_x = rect->hx - inset;
+    float extent_y = rect->hy - inset;
+    rect->solid_x0 = rect->solid_x1 = rect->solid_y0 = rect->solid_y1 = 0;
+    if ((fill >> 24) == 0xFF && extent_x >= 0.0f && extent_y >= 0.0f) {
+        float solid_x0 = ceilf(rect->cx - extent_x - 0.5f);
+        float solid_y0 = ceilf(rect->cy - extent_y - 0.5f);
+        float solid_x1 = floorf(rect->cx + extent_x - 0.5f) + 1.0f;
+        float solid_y1 = floorf(rect->cy + extent_y - 0.5f) + 1.0f;
+        rect->solid_x0 = imsdl_raster_clamp_pixel(solid_x0, rect->x0, rect->x1);
+        rect->solid_y0 = imsdl_raster_clamp_pixel(solid_y0, rect->y0, rect->y1);
+        rect->solid_x1 = imsdl_raster_clamp_pixel(solid_x1, rect->x0, rect->x1);
+        rect->solid_y1 = imsdl_raster_clamp_pixel(solid_y1, rect->y0, rect->y1);
+        rect->solid = fill;
+    }
+    return true;
+}
+
+/**
+ * @brief Computes the pixels a triangle touches, clipped to the target.
+ *
+ * @return False if it touches none.
+ */
+static bool imsdl_raster_triangle_bounds(
+    const IMSDL_Raster* raster, uint32_t first, int* x0, int* y0, int* x1, int* y1
+) {
+    const IMSDL_Vertex* vertices = imsdl_draw_list_vertices(raster->list);
+    const IMSDL_Index* indices = imsdl_draw_list_indices(raster->list) + first;
+    const IMSDL_Vertex* a = &vertices[indices[0]];
+    const IMSDL_Vertex* b = &vertices[indices[1]];
+    const IMSDL_Vertex* c = &vertices[indices[2]];
+
+    // A non-finite vertex has no meaningful coverage or bounds
+    if (!isfinite(a->x) || !isfinite(a->y) || !isfinite(b->x) || !isfinite(b->y)
+        || !isfinite(c->x) || !isfinite(c->y)) {
+        return false;
+    }
+
+    *x0 = imsdl_raster_clamp_pixel(floorf(fminf(a->x, fminf(b->x, c->x))), 0, raster->width);
+    *y0 = imsdl_raster_clamp_pixel(floorf(fminf(a->y, fminf(b->y, c->y))), 0, raster->height);
+    *x1 = imsdl_raster_clamp_pixel(ceilf(fmaxf(a->x, fmaxf(b->x, c->x))), 0, raster->width);
+    *y1 = imsdl_raster_clamp_pixel(ceilf(fmaxf(a->y, fmaxf(b->y, c->y))), 0, raster->height);
+    return *x0 < *x1 && *y0 < *y1;
+}
+
+// --- Binning ---
+
+/**
+ * @brief Counts or stores one entry in every tile overlapping a pixel box.
+ */
+static void imsdl_raster_add(
+    IMSDL_Raster* raster, int x0, int y0, int x1, int y1, uint32_t entry, bool store
+) {
+    int tx0 = x0 / IMSDL_RASTER_TILE_SIZE;
+    int ty0 = y0 / IMSDL_RASTER_TILE_SIZE;
+    int tx1 = (x1 - 1) / IMSDL_RASTER_TILE_SIZE;
+    int ty1 = (y1 - 1) / IMSDL_RASTER_TILE_SIZE;
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            size_t tile = (size_t) ty * (size_t) raster->tiles_x + (size_t) tx;
+            if (store) {
+                raster->bins[raster->cursors[tile]++] = entry;
+            } else {
+                raster->offsets[tile + 1]++;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Walks the commands in submission order, counting or storing bin entries.
+ *
+ * Rects are set up on the counting pass and reused on the storing pass.
+ */
+static void imsdl_raster_visit(IMSDL_Raster* raster, bool store) {
+    const IMSDL_DrawCommand* commands = imsdl_draw_list_commands(raster->list);
+    const IMSDL_RectInstance* instances = imsdl_draw_list_rects(raster->list);
+
+    for (uint32_t i = 0; i < raster->list->command_count; i++) {
+        const IMSDL_DrawCommand* command = &commands[i];
+        uint32_t end = command->offset + command->count;
+        if (command->kind == IMSDL_DRAW_RECTS) {
+            for (uint32_t r = command->offset; r < end; r++) {
+                IMSDL_RasterRect* rect = &raster->rects[r];
+                if (!store && !imsdl_raster_setup_rect(raster, &instances[r], rect)) {
+                    rect->x1 = rect->x0; // Empty, skipped on the storing pass
+                }
+                if (rect->x0 < rect->x1) {
+                    imsdl_raster_add(raster, rect->x0, rect->y0, rect->x1, rect->y1, r, store);
+                }
+            }
+        } else {
+            for (uint32_t t = command->offset; t + 3 <= end; t += 3) {
+                int x0, y0, x1, y1;
+                if (imsdl_raster_triangle_bounds(raster, t, &x0, &y0, &x1, &y1)) {
+                    imsdl_raster_add(raster, x0, y0, x1, y1, t | IMSDL_RASTER_TRIANGLE, store);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Grows an array to hold at least count elements.
+ */
+static bool imsdl_raster_reserve(void** array, size_t* capacity, size_t count, size_t size) {
+    if (count <= *capacity) {
+        return true;
+    }
+
+    size_t grown = *capacity ? *capacity : 256;
+    while (grown < count) {
+        grown *= 2;
+    }
+    void* resized = realloc(*array, grown * size);
+    if (!resized) {
+        LOG_ERROR("Failed to grow rasterizer array to %zu elements.", grown);
+        return false;
+    }
+    *array = resized;
+    *capacity = grown;
+    return true;
+}
+
+/**
+ * @brief Sorts this frame's primitives into per-tile bins, keeping submission order.
+ */
+static bool imsdl_raster_bin(IMSDL_Raster* raster) {
+    size_t tiles = (size_t) raster->tiles_x * (size_t) raster->tiles_y;
+    if (tiles + 1 > raster->tile_capacity) {
+        uint32_t* offsets = (uint32_t*) realloc(raster->offsets, (tiles + 1) * sizeof(uint32_t));
+        if (offsets) {
+            raster->offsets = offsets;
+        }
+        uint32_t* cursors = (uint32_t*) realloc(raster->cursors, (tiles + 1) * sizeof(uint32_t));
+        if (cursors) {
+            raster->cursors = cursors;
+        }
+        if (!offsets || !cursors) {
+            LOG_ERROR("Failed to allocate rasterizer tiles (tiles=%zu).", tiles);
+            return false;
+        }
+        raster->tile_capacity = tiles + 1;
+    }
+
+    size_t rect_count = raster->list->rect_count;
+    if (!imsdl_raster_reserve(
+            (void**) &raster->rects, &raster->rect_capacity, rect_count, sizeof(IMSDL_RasterRect)
+        )) {
+        return false;
+    }
+
+    // Count per tile, then turn the counts into offsets
+    memset(raster->offsets, 0, (tiles + 1) * sizeof(uint32_t));
+    imsdl_raster_visit(raster, false);
+    size_t total = 0;
+    for (size_t t = 0; t < tiles; t++) {
+        total += raster->offsets[t + 1];
+        if (total > UINT32_MAX) {
+            LOG_ERROR("Rasterizer bins overflow (%zu entries).", total);
+            return false;
+        }
+        raster->offsets[t + 1] = (uint32_t) total;
+    }
+
+    if (!imsdl_raster_reserve(
+            (void**) &raster->bins, &raster->bin_capacity, total, sizeof(uint32_t)
+        )) {
+        return false;
+    }
+    memcpy(raster->cursors, raster->offsets, tiles * sizeof(uint32_t));
+    imsdl_raster_visit(raster, true);
+    return true;
+}
+
+// --- Tile Drawing ---
+
+static void imsdl_raster_draw_rect(
+    IMSDL_Raster* raster, const IMSDL_RasterRect* rect, int x0, int y0, int x1, int y1
+) {
+    int rx0 = rect->x0 > x0 ? rect->x0 : x0;
+    int ry0 = rect->y0 > y0 ? rect->y0 : y0;
+    int rx1 = rect->x1 < x1 ? rect->x1 : x1;
+    int ry1 = rect->y1 < y1 ? rect->y1 : y1;
+
+    for (int y = ry0; y < ry1; y++) {
+        uint32_t* row = raster->pixels + (size_t) y * raster->pitch;
+        if (y < rect->solid_y0 || y >= rect->solid_y1) {
+            raster->span(row + rx0, rx1 - rx0, rx0, y, rect);
+            continue;
+        }
+
+        // Shade the anti-aliased edges; the covered interior is a plain fill
+        int sx0 = rect->solid_x0 < rx0 ? rx0 : (rect->solid_x0 > rx1 ? rx1 : rect->solid_x0);
+        int sx1 = rect->solid_x1 < sx0 ? sx0 : (rect->solid_x1 > rx1 ? rx1 : rect->solid_x1);
+        if (sx0 > rx0) {
+            raster->span(row + rx0, sx0 - rx0, rx0, y, rect);
+        }
+        for (int x = sx0; x < sx1; x++) {
+            row[x] = rect->solid;
+        }
+        if (rx1 > sx1) {
+            raster->span(row + sx1, rx1 - sx1, sx1, y, rect);
+        }
+    }
+}
+
+/**
+ * @brief Edge function: twice the signed area of (p, q, r).
+ */
+static float imsdl_raster_edge(const IMSDL_Vertex* p, const IMSDL_Vertex* q, float x, float y) {
+    return (q->x - p->x) * (y - p->y) - (q->y - p->y) * (x - p->x);
+}
+
+/**
+ * @brief Whether pixels exactly on edge p -> q belong to this triangle.
+ *
+ * Opposite directions give opposite answers, so a shared edge is drawn once.
+ */
+static bool imsdl_raster_owns_edge(const IMSDL_Vertex* p, const IMSDL_Vertex* q) {
+    float dy = q->y - p->y;
+    return dy > 0.0f || (dy == 0.0f && q->x < p->x);
+}
+
+static void imsdl_raster_draw_triangle(
+    IMSDL_Raster* raster, uint32_t first, int x0, int y0, int x1, int y1
+) {
+    const IMSDL_Vertex* vertices = imsdl_draw_list_vertices(raster->list);
+    const IMSDL_Index* indices = imsdl_draw_list_indices(raster->list) + first;
+    const IMSDL_Vertex* a = &vertices[indices[0]];
+    const IMSDL_Vertex* b = &vertices[indices[1]];
+    const IMSDL_Vertex* c = &vertices[indices[2]];
+
+    // GL does not cull, so accept either winding by making it positive
+    float area = imsdl_raster_edge(a, b, c->x, c->y);
+    if (area == 0.0f) {
+        return;
+    }
+    if (area < 0.0f) {
+        const IMSDL_Vertex* swap = b;
+        b = c;
+        c = swap;
+        area = -area;
+    }
+
+    int tx0, ty0, tx1, ty1;
+    imsdl_raster_triangle_bounds(raster, first, &tx0, &ty0, &tx1, &ty1);
+    tx0 = tx0 > x0 ? tx0 : x0;
+    ty0 = ty0 > y0 ? ty0 : y0;
+    tx1 = tx1 < x1 ? tx1 : x1;
+    ty1 = ty1 < y1 ? ty1 : y1;
+
+    bool owns_a = imsdl_raster_owns_edge(b, c);
+    bool owns_b = imsdl_raster_owns_edge(c, a);
+    bool owns_c = imsdl_raster_owns_edge(a, b);
+
+    float colors[3][4];
+    const IMSDL_Vertex* corners[3] = {a, b, c};
+    for (int v = 0; v < 3; v++) {
+        uint32_t color = imsdl_raster_swizzle(corners[v]->color, raster->swap_rb);
+        for (int k = 0; k < 4; k++) {
+            colors[v][k] = (float) ((color >> (k * 8)) & 0xFF);
+        }
+    }
+
+    float inverse_area = 1.0f / area;
+    for (int y = ty0; y < ty1; y++) {
+        uint32_t* row = raster->pixels + (size_t) y * raster->pitch;
+        float py = (float) y + 0.5f;
+        for (int x = tx0; x < tx1; x++) {
+            float px = (float) x + 0.5f;
+            float wa = imsdl_raster_edge(b, c, px, py);
+            float wb = imsdl_raster_edge(c, a, px, py);
+            float wc = imsdl_raster_edge(a, b, px, py);
+            if (wa < 0.0f || wb < 0.0f || wc < 0.0f || (wa == 0.0f && !owns_a)
+                || (wb == 0.0f && !owns_b) || (wc == 0.0f && !owns_c)) {
+                continue;
+            }
+
+            // Straight alpha over the target, as glBlendFunc(GL_SRC_ALPHA, ...)
+            wa *= inverse_area;
+            wb *= inverse_area;
+            wc *= inverse_area;
+            float alpha = wa * colors[0][3] + wb * colors[1][3] + wc * colors[2][3];
+            float coverage = alpha * (1.0f / 255.0f);
+            uint32_t dst = row[x];
+            uint32_t out = 0;
+            for (int k = 0; k < 4; k++) {
+                float source = alpha;
+                if (k < 3) {
+                    source = (wa * colors[0][k] + wb * colors[1][k] + wc * colors[2][k]) * coverage;
+                }
+                float value = source + (float) ((dst >> (k * 8)) & 0xFF) * (1.0f - coverage);
+                out |= (uint32_t) lrintf(fminf(value, 255.0f)) << (k * 8);
+            }
+            row[x] = out;
+        }
+    }
+}
+
+static void imsdl_raster_draw_tile(IMSDL_Raster* raster, uint32_t tile) {
+    int x0 = (int) (tile % (uint32_t) raster->tiles_x) * IMSDL_RASTER_TILE_SIZE;
+    int y0 = (int) (tile / (uint32_t) raster->tiles_x) * IMSDL_RASTER_TILE_SIZE;
+    int x1 = x0 + IMSDL_RASTER_TILE_SIZE;
+    int y1 = y0 + IMSDL_RASTER_TILE_SIZE;
+    x1 = x1 < raster->width ? x1 : raster->width;
+    y1 = y1 < raster->height ? y1 : raster->height;
+
+    // Clearing per tile keeps the clear parallel and the tile hot in cache
+    for (int y = y0; y < y1; y++) {
+        uint32_t* row = raster->pixels + (size_t) y * raster->pitch;
+        for (int x = x0; x < x1; x++) {
+            row[x] = raster->clear;
+        }
+    }
+
+    for (uint32_t i = raster->offsets[tile]; i < raster->offsets[tile + 1]; i++) {
+        uint32_t entry = raster->bins[i];
+        if (entry & IMSDL_RASTER_TRIANGLE) {
+            imsdl_raster_draw_triangle(raster, entry & ~IMSDL_RASTER_TRIANGLE, x0, y0, x1, y1);
+        } else {
+            imsdl_raster_draw_rect(raster, &raster->rects[entry], x0, y0, x1, y1);
+        }
+    }
+}
+
+// --- Threads ---
+
+/**
+ * @brief Claims and draws tiles until none are left.
+ */
+static void imsdl_raster_run(IMSDL_Raster* raster) {
+    uint32_t tiles = (uint32_t) raster->tiles_x * (uint32_t) raster->tiles_y;
+    for (;;) {
+        uint32_t tile = atomic_fetch_add_explicit(&raster->next_tile, 1, memory_order_relaxed);
+        if (tile >= tiles) {
+            return;
+        }
+        imsdl_raster_draw_tile(raster, tile);
+    }
+}
+
+static void* imsdl_raster_worker(void* arg) {
+    IMSDL_Raster* raster = (IMSDL_Raster*) arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&raster->lock);
+    for (;;) {
+        while (raster->generation == seen && !raster->stop) {
+            pthread_cond_wait(&raster->start, &raster->lock);
+        }
+        if (raster->stop) {
+            break;
+        }
+        seen = raster->generation;
+        pthread_mutex_unlock(&raster->lock);
+
+        imsdl_raster_run(raster);
+
+        pthread_mutex_lock(&raster->lock);
+        if (--raster->busy == 0) {
+            pthread_cond_signal(&raster->done);
+        }
+    }
+    pthread_mutex_unlock(&raster->lock);
+    return NULL;
+}
+
+// --- Rasterizer ---
+
+IMSDL_Raster* imsdl_raster_create(int threads) {
+    IMSDL_Raster* raster = (IMSDL_Raster*) calloc(1, sizeof(IMSDL_Raster));
+    if (!raster) {
+        LOG_ERROR("Failed to allocate memory for rasterizer.");
+        return NULL;
+    }
+
+    raster->span = imsdl_raster_span_scalar;
+    raster->kernel = "scalar";
+#ifdef IMSDL_RASTER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        raster->span = imsdl_raster_span_avx2;
+        raster->kernel = "avx2";
+    } else if (__builtin_cpu_supports("sse2")) {
+        raster->span = imsdl_raster_span_sse2;
+        raster->kernel = "sse2";
+    }
+#endif
+
+    if (pthread_mutex_init(&raster->lock, NULL) != 0) {
+        LOG_ERROR("Failed to initialize rasterizer mutex.");
+        free(raster);
+        return NULL;
+    }
+    if (pthread_cond_init(&raster->start, NULL) != 0) {
+        LOG_ERROR("Failed to initialize rasterizer start condition.");
+        pthread_mutex_destroy(&raster->lock);
+        free(raster);
+        return NULL;
+    }
+    if (pthread_cond_init(&raster->done, NULL) != 0) {
+        LOG_ERROR("Failed to initialize rasterizer done condition.");
+        pthread_cond_destroy(&raster->start);
+        pthread_mutex_destroy(&raster->lock);
+        free(raster);
+        return NULL;
+    }
+
+    if (threads < 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 1 ? (int) cpus - 1 : 0;
+    }
+    if (threads > IMSDL_RASTER_MAX_THREADS) {
+        threads = IMSDL_RASTER_MAX_THREADS;
+    }
+
+    // Fewer workers only costs speed, so keep whatever could be started
+    for (int i = 0; i < threads; i++) {
+        int error_code = pthread_create(&raster->threads[i], NULL, imsdl_raster_worker, raster);
+        if (error_code != 0) {
+            LOG_WARN("Started %d of %d rasterizer threads (error %d).", i, threads, error_code);
+            break;
+        }
+        raster->thread_count++;
+    }
+
+    LOG_DEBUG("Rasterizer: %s kernel, %d worker threads.", raster->kernel, raster->thread_count);
+    return raster;
+}
+
+void imsdl_raster_free(IMSDL_Raster* raster) {
+    if (raster) {
+        pthread_mutex_lock(&raster->lock);
+        raster->stop = true;
+        pthread_cond_broadcast(&raster->start);
+        pthread_mutex_unlock(&raster->lock);
+        for (int i = 0; i < raster->thread_count; i++) {
+            pthread_join(raster->threads[i], NULL);
+        }
+
+        pthread_cond_destroy(&raster->done);
+        pthread_cond_destroy(&raster->start);
+        pthread_mutex_destroy(&raster->lock);
+        free(raster->offsets);
+        free(raster->cursors);
+        free(raster->bins);
+        free(raster->rects);
+        free(raster);
+    }
+}
+
+bool imsdl_raster_render(
+    IMSDL_Raster* raster,
+    const IMSDL_DrawList* list,
+    uint32_t* pixels,
+    size_t pitch,
+    int width,
+    int height,
+    uint32_t clear
+) {
+    if (width <= 0 || height <= 0) {
+        return true;
+    }
+
+    raster->list = list;
+    raster->pixels = pixels;
+    raster->pitch = pitch;
+    raster->width = width;
+    raster->height = height;
+    raster->clear = imsdl_raster_swizzle(clear, raster->swap_rb);
+    raster->tiles_x = (width + IMSDL_RASTER_TILE_SIZE - 1) / IMSDL_RASTER_TILE_SIZE;
+    raster->tiles_y = (height + IMSDL_RASTER_TILE_SIZE - 1) / IMSDL_RASTER_TILE_SIZE;
+    if (!imsdl_raster_bin(raster)) {
+        return false;
+    }
+
+    // The mutex publishes the bins to the workers; the caller draws tiles too
+    atomic_store_explicit(&raster->next_tile, 0, memory_order_relaxed);
+    if (raster->thread_count > 0) {
+        pthread_mutex_lock(&raster->lock);
+        raster->busy = raster->thread_count;
+        raster->generation++;
+        pthread_cond_broadcast(&raster->start);
+        pthread_mutex_unlock(&raster->lock);
+    }
+
+    imsdl_raster_run(raster);
+
+    if (raster->thread_count > 0) {
+        pthread_mutex_lock(&raster->lock);
+        while (raster->busy > 0) {
+            pthread_cond_wait(&raster->done, &raster->lock);
+        }
+        pthread_mutex_unlock(&raster->lock);
+    }
+    return true;
+}
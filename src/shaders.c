@@ -6,32 +6,156 @@
 #include "shaders.h"
 #include "logger.h"
 
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Identifies a program cache file and its layout
+#define IMSDL_PROGRAM_CACHE_MAGIC "IMSDLPRG"
+#define IMSDL_PROGRAM_CACHE_VERSION 1
+
+// Larger cache files are treated as corrupt rather than read
+#define IMSDL_PROGRAM_CACHE_MAX_SIZE (64u * 1024u * 1024u)
+
+/**
+ * @brief Header written in front of a cached program binary.
+ */
+typedef struct IMSDL_ProgramCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t format; // Binary format reported by glGetProgramBinary
+    uint64_t key; // Hash of the sources and driver, repeated from the file name
+    uint64_t size; // Bytes of binary following the header
+} IMSDL_ProgramCacheHeader;
+
+// --- Sources ---
 
 char* imsdl_read_shader(const char* filepath) {
-    FILE* file = fopen(filepath, "r");
+    FILE* file = fopen(filepath, "rb");
     if (!file) {
         LOG_ERROR("Failed to open file: %s", filepath);
         return NULL;
     }
 
-    fseek(file, 0, SEEK_END);
-    size_t length = ftell(file);
-    rewind(file);
+    long length = -1;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        length = ftell(file);
+    }
+    if (length < 0 || fseek(file, 0, SEEK_SET) != 0) {
+        LOG_ERROR("Failed to get size of file: %s", filepath);
+        fclose(file);
+        return NULL;
+    }
 
-    char* buffer = (char*) malloc(length + 1);
-    buffer[length] = '\0';
-    fread(buffer, 1, length, file);
+    char* buffer = (char*) malloc((size_t) length + 1);
+    if (!buffer) {
+        LOG_ERROR("Failed to allocate memory for file: %s (size=%ld)", filepath, length);
+        fclose(file);
+        return NULL;
+    }
 
+    size_t read = fread(buffer, 1, (size_t) length, file);
     fclose(file);
+    if (read != (size_t) length) {
+        LOG_ERROR("Failed to read file: %s (%zu of %ld bytes)", filepath, read, length);
+        free(buffer);
+        return NULL;
+    }
+
+    buffer[length] = '\0';
     return buffer;
 }
 
-GLuint imsdl_compile_shader(const char* source, GLenum type) {
+/**
+ * @brief Maps directory/name read-only.
+ *
+ * @return False if the file does not exist or cannot be mapped.
+ */
+static bool imsdl_map_shader(const char* directory, const char* name, IMSDL_ShaderText* text) {
+    char path[PATH_MAX];
+    int written = snprintf(path, sizeof(path), "%s/%s", directory, name);
+    if (written < 0 || (size_t) written >= sizeof(path)) {
+        return false;
+    }
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0;
+    if (ok && info.st_size == 0) {
+        *text = (IMSDL_ShaderText) {"", 0, false}; // mmap rejects empty files
+    } else if (ok) {
+        void* data = mmap(NULL, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ok = data != MAP_FAILED;
+        if (ok) {
+            *text = (IMSDL_ShaderText) {(const char*) data, (size_t) info.st_size, true};
+        }
+    }
+    if (!ok) {
+        LOG_ERROR("Failed to map shader %s: %s", path, strerror(errno));
+    }
+    close(fd);
+    return ok;
+}
+
+bool imsdl_load_shader(const char* name, IMSDL_ShaderText* text) {
+    *text = (IMSDL_ShaderText) {NULL, 0, false};
+
+    const char* directory = getenv(IMSDL_SHADER_DIR_ENV);
+    if (directory && *directory) {
+        if (imsdl_map_shader(directory, name, text)) {
+            LOG_DEBUG("Loaded shader %s from %s.", name, directory);
+            return true;
+        }
+    }
+
+    for (size_t i = 0; i < imsdl_shader_source_count; i++) {
+        if (strcmp(imsdl_shader_sources[i].name, name) == 0) {
+            text->data = imsdl_shader_sources[i].text;
+            text->size = imsdl_shader_sources[i].size;
+            return true;
+        }
+    }
+
+    LOG_ERROR("Unknown shader: %s", name);
+    return false;
+}
+
+void imsdl_release_shader(IMSDL_ShaderText* text) {
+    if (text->mapped) {
+        munmap((void*) text->data, text->size);
+    }
+    *text = (IMSDL_ShaderText) {NULL, 0, false};
+}
+
+// --- Shaders ---
+
+/**
+ * @brief Submits length bytes of source for compilation without waiting for the result.
+ *
+ * A negative length reads up to the terminator.
+ */
+static GLuint imsdl_submit_shader(const char* source, GLint length, GLenum type) {
     GLuint shader = glCreateShader(type);
-    glShaderSource(shader, 1, &source, NULL);
+    glShaderSource(shader, 1, &source, &length);
     glCompileShader(shader);
+    return shader;
+}
 
+/**
+ * @brief Waits for a submitted shader and logs why it failed to compile.
+ */
+static bool imsdl_check_shader(GLuint shader) {
     GLint success;
     glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
     if (!success) {
@@ -39,35 +163,356 @@ GLuint imsdl_compile_shader(const char* source, GLenum type) {
         glGetShaderInfoLog(shader, 512, NULL, infoLog);
         LOG_ERROR("Shader Compilation Failed: %s", infoLog);
     }
+    return success;
+}
 
+GLuint imsdl_compile_shader(const char* source, GLenum type) {
+    GLuint shader = imsdl_submit_shader(source, -1, type);
+    imsdl_check_shader(shader);
     return shader;
 }
 
-GLuint imsdl_create_shader_program(const char* vertex_file, const char* fragment_file) {
-    char* vertex_source = imsdl_read_shader(vertex_file);
-    char* fragment_source = imsdl_read_shader(fragment_file);
+// --- Program Binary Cache ---
+
+/**
+ * @brief FNV-1a over size bytes, continuing from hash.
+ */
+static uint64_t imsdl_fnv1a(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = (const uint8_t*) data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Hashes both sources; the first half of a cache key, computed without GL.
+ *
+ * Each field is followed by a zero byte so fields cannot run together.
+ */
+static uint64_t imsdl_shader_source_hash(
+    const IMSDL_ShaderText* vertex, const IMSDL_ShaderText* fragment
+) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    hash = imsdl_fnv1a(hash, vertex->data, vertex->size);
+    hash = imsdl_fnv1a(hash, "", 1);
+    hash = imsdl_fnv1a(hash, fragment->data, fragment->size);
+    return imsdl_fnv1a(hash, "", 1);
+}
+
+/**
+ * @brief Mixes the driver that will consume the binary into a source hash.
+ */
+static uint64_t imsdl_program_cache_key(uint64_t source_hash) {
+    const char* driver[] = {
+        (const char*) glGetString(GL_VENDOR),
+        (const char*) glGetString(GL_RENDERER),
+        (const char*) glGetString(GL_VERSION),
+    };
+
+    uint64_t hash = source_hash;
+    for (size_t i = 0; i < sizeof(driver) / sizeof(driver[0]); i++) {
+        const char* field = driver[i] ? driver[i] : "";
+        hash = imsdl_fnv1a(hash, field, strlen(field) + 1);
+    }
+    return hash;
+}
+
+/**
+ * @brief Finds the cache directory: IMSDL_SHADER_CACHE_ENV if set, then
+ * $XDG_CACHE_HOME/imsdl, then $HOME/.cache/imsdl.
+ *
+ * @return The directory, possibly written to buffer, or NULL if the cache is disabled.
+ */
+static const char* imsdl_program_cache_directory(char* buffer, size_t size) {
+    const char* directory = getenv(IMSDL_SHADER_CACHE_ENV);
+    if (!directory) {
+        const char* xdg = getenv("XDG_CACHE_HOME");
+        const char* home = getenv("HOME");
+        if (xdg && *xdg) {
+            snprintf(buffer, size, "%s/imsdl", xdg);
+        } else if (home && *home) {
+            snprintf(buffer, size, "%s/.cache/imsdl", home);
+        } else {
+            return NULL;
+        }
+        directory = buffer;
+    }
+    return *directory ? directory : NULL;
+}
+
+/**
+ * @brief Builds the cache file path for key.
+ *
+ * @return False if the cache is disabled or no directory can be found.
+ */
+static bool imsdl_program_cache_path(uint64_t key, char* path, size_t size) {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    if (!(GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary) || formats == 0) {
+        return false; // The driver cannot hand programs back
+    }
 
-    GLuint vertex_shader = imsdl_compile_shader(vertex_source, GL_VERTEX_SHADER);
-    GLuint fragment_shader = imsdl_compile_shader(fragment_source, GL_FRAGMENT_SHADER);
+    char buffer[PATH_MAX];
+    const char* directory = imsdl_program_cache_directory(buffer, sizeof(buffer));
+    if (!directory) {
+        return false;
+    }
 
-    GLuint shader_program = glCreateProgram();
-    glAttachShader(shader_program, vertex_shader);
-    glAttachShader(shader_program, fragment_shader);
-    glLinkProgram(shader_program);
+    int written = snprintf(path, size, "%s/%016llx.bin", directory, (unsigned long long) key);
+    return written > 0 && (size_t) written < size;
+}
+
+/**
+ * @brief Creates every missing directory leading up to the file at path.
+ */
+static bool imsdl_program_cache_mkdir(const char* path) {
+    char directory[PATH_MAX];
+    snprintf(directory, sizeof(directory), "%s", path);
+    char* end = strrchr(directory, '/');
+    if (!end || end == directory) {
+        return true;
+    }
+    *end = '\0';
+
+    for (char* slash = strchr(directory + 1, '/');; slash = strchr(slash + 1, '/')) {
+        if (slash) {
+            *slash = '\0';
+        }
+        if (mkdir(directory, 0755) != 0 && errno != EEXIST) {
+            LOG_WARN("Failed to create shader cache directory %s: %s", directory, strerror(errno));
+            return false;
+        }
+        if (!slash) {
+            return true;
+        }
+        *slash = '/';
+    }
+}
+
+/**
+ * @brief Loads a program from the cache.
+ *
+ * Files that are unreadable, from another build, or rejected by the driver
+ * are deleted so the next run stores a fresh binary.
+ *
+ * @return The linked program, or 0 on a miss.
+ */
+static GLuint imsdl_program_cache_load(uint64_t key, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        return 0;
+    }
+
+    IMSDL_ProgramCacheHeader header;
+    void* binary = NULL;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1
+                 && memcmp(header.magic, IMSDL_PROGRAM_CACHE_MAGIC, sizeof(header.magic)) == 0
+                 && header.version == IMSDL_PROGRAM_CACHE_VERSION && header.key == key
+                 && header.size > 0 && header.size <= IMSDL_PROGRAM_CACHE_MAX_SIZE;
+    if (valid) {
+        binary = malloc((size_t) header.size);
+        valid = binary && fread(binary, 1, (size_t) header.size, file) == header.size;
+    }
+    fclose(file);
+
+    GLuint program = 0;
+    if (valid) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary, (GLsizei) header.size);
+
+        GLint success = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            // Usually a driver update that kept the version string
+            LOG_WARN("Cached shader program rejected by the driver: %s", path);
+            glDeleteProgram(program);
+            program = 0;
+        }
+    } else {
+        LOG_WARN("Discarding unreadable shader cache file: %s", path);
+    }
+    free(binary);
+
+    if (!program) {
+        remove(path);
+    }
+    return program;
+}
+
+/**
+ * @brief Writes a linked program's binary to the cache.
+ *
+ * Written to a temporary file and renamed, so a concurrent reader never
+ * sees a partial binary.
+ */
+static void imsdl_program_cache_store(GLuint program, uint64_t key, const char* path) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0 || (uint64_t) length > IMSDL_PROGRAM_CACHE_MAX_SIZE) {
+        return;
+    }
+
+    void* binary = malloc((size_t) length);
+    if (!binary) {
+        LOG_ERROR("Failed to allocate memory for program binary (size=%d).", length);
+        return;
+    }
+
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, binary);
+
+    IMSDL_ProgramCacheHeader header = {{0}, IMSDL_PROGRAM_CACHE_VERSION, format, key, 0};
+    memcpy(header.magic, IMSDL_PROGRAM_CACHE_MAGIC, sizeof(header.magic));
+    header.size = (uint64_t) written;
+
+    char temporary[PATH_MAX + 32];
+    snprintf(temporary, sizeof(temporary), "%s.%ld.tmp", path, (long) getpid());
+
+    FILE* file = NULL;
+    if (written > 0 && imsdl_program_cache_mkdir(path)) {
+        file = fopen(temporary, "wb");
+    }
+    if (file) {
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+                  && fwrite(binary, 1, (size_t) written, file) == (size_t) written;
+        ok = fclose(file) == 0 && ok;
+        if (!ok || rename(temporary, path) != 0) {
+            LOG_WARN("Failed to write shader cache file: %s", path);
+            remove(temporary);
+        }
+    }
+    free(binary);
+}
+
+void imsdl_prefetch_shader_cache(void) {
+    char buffer[PATH_MAX];
+    const char* directory = imsdl_program_cache_directory(buffer, sizeof(buffer));
+    DIR* dir = directory ? opendir(directory) : NULL;
+    if (!dir) {
+        return; // Disabled, or nothing stored yet
+    }
+
+    // The key needs the driver strings, so warm every binary rather than guess
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t length = strlen(entry->d_name);
+        if (length < 4 || strcmp(entry->d_name + length - 4, ".bin") != 0) {
+            continue;
+        }
+        int fd = openat(dirfd(dir), entry->d_name, O_RDONLY | O_CLOEXEC);
+        if (fd >= 0) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+            close(fd);
+        }
+    }
+    closedir(dir);
+}
+
+// --- Programs ---
+
+bool imsdl_prepare_shader_program(
+    IMSDL_ShaderProgramSource* source, const char* vertex_name, const char* fragment_name
+) {
+    source->vertex_name = vertex_name;
+    source->fragment_name = fragment_name;
+    source->hash = 0;
+    bool loaded = imsdl_load_shader(vertex_name, &source->vertex);
+    loaded = imsdl_load_shader(fragment_name, &source->fragment) && loaded;
+    if (!loaded) {
+        imsdl_release_shader_program(source);
+        return false;
+    }
+
+    // Hashing also faults in mapped files, so the render thread does not
+    source->hash = imsdl_shader_source_hash(&source->vertex, &source->fragment);
+    return true;
+}
+
+void imsdl_release_shader_program(IMSDL_ShaderProgramSource* source) {
+    imsdl_release_shader(&source->vertex);
+    imsdl_release_shader(&source->fragment);
+}
+
+void imsdl_begin_shader_program(IMSDL_ShaderBuild* build, const IMSDL_ShaderProgramSource* source) {
+    build->program = 0;
+    build->vertex_shader = 0;
+    build->fragment_shader = 0;
+    build->vertex_name = source->vertex_name;
+    build->fragment_name = source->fragment_name;
+
+    // A cached binary skips compiling and linking entirely
+    build->key = imsdl_program_cache_key(source->hash);
+    build->cache
+        = imsdl_program_cache_path(build->key, build->cache_path, sizeof(build->cache_path));
+    if (build->cache) {
+        build->program = imsdl_program_cache_load(build->key, build->cache_path);
+        if (build->program) {
+            LOG_DEBUG(
+                "Loaded shader program %s + %s from cache.",
+                source->vertex_name,
+                source->fragment_name
+            );
+            build->cache = false;
+            return;
+        }
+    }
+
+    // Sources are passed with their lengths; mapped files have no terminator
+    const IMSDL_ShaderText* vertex = &source->vertex;
+    const IMSDL_ShaderText* fragment = &source->fragment;
+    build->vertex_shader
+        = imsdl_submit_shader(vertex->data, (GLint) vertex->size, GL_VERTEX_SHADER);
+    build->fragment_shader
+        = imsdl_submit_shader(fragment->data, (GLint) fragment->size, GL_FRAGMENT_SHADER);
+
+    build->program = glCreateProgram();
+    glAttachShader(build->program, build->vertex_shader);
+    glAttachShader(build->program, build->fragment_shader);
+    if (build->cache) {
+        glProgramParameteri(build->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+    glLinkProgram(build->program);
+}
+
+GLuint imsdl_end_shader_program(IMSDL_ShaderBuild* build) {
+    if (!build->vertex_shader) {
+        return build->program; // Loaded from the cache, already linked
+    }
 
     GLint success;
-    glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
+    glGetProgramiv(build->program, GL_LINK_STATUS, &success);
     if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(shader_program, 512, NULL, infoLog);
-        LOG_ERROR("Shader Program Linking Failed: %s", infoLog);
+        // Compile errors explain most link failures, so report those first
+        bool compiled = imsdl_check_shader(build->vertex_shader);
+        compiled = imsdl_check_shader(build->fragment_shader) && compiled;
+        if (compiled) {
+            char infoLog[512];
+            glGetProgramInfoLog(build->program, 512, NULL, infoLog);
+            LOG_ERROR("Shader Program Linking Failed: %s", infoLog);
+        }
+    } else if (build->cache) {
+        imsdl_program_cache_store(build->program, build->key, build->cache_path);
     }
 
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
+    glDeleteShader(build->vertex_shader);
+    glDeleteShader(build->fragment_shader);
+    build->vertex_shader = 0;
+    build->fragment_shader = 0;
+    return build->program;
+}
 
-    free(vertex_source);
-    free(fragment_source);
+GLuint imsdl_create_shader_program(const char* vertex_name, const char* fragment_name) {
+    IMSDL_ShaderProgramSource source;
+    if (!imsdl_prepare_shader_program(&source, vertex_name, fragment_name)) {
+        return 0;
+    }
 
-    return shader_program;
+    IMSDL_ShaderBuild build;
+    imsdl_begin_shader_program(&build, &source);
+    GLuint program = imsdl_end_shader_program(&build);
+    imsdl_release_shader_program(&source);
+    return program;
 }
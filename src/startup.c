@@ -0,0 +1,149 @@
+/**
+ * @file src/startup.c
+ * @brief Startup pipeline and timing breakdown.
+ */
+
+#include "startup.h"
+#include "logger.h"
+#include "profile.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief One recorded stage of startup.
+ */
+typedef struct IMSDL_StartupStage {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} IMSDL_StartupStage;
+
+static pthread_mutex_t imsdl_startup_lock = PTHREAD_MUTEX_INITIALIZER;
+static IMSDL_StartupStage imsdl_startup_stages[IMSDL_STARTUP_STAGES];
+static size_t imsdl_startup_stage_count = 0;
+
+// --- Timing ---
+
+void imsdl_startup_record(const char* name, uint64_t start_ns) {
+    uint64_t end_ns = profile_now_ns();
+    pthread_mutex_lock(&imsdl_startup_lock);
+    if (imsdl_startup_stage_count < IMSDL_STARTUP_STAGES) {
+        imsdl_startup_stages[imsdl_startup_stage_count++]
+            = (IMSDL_StartupStage) {name, start_ns, end_ns};
+    }
+    pthread_mutex_unlock(&imsdl_startup_lock);
+}
+
+static int imsdl_startup_compare(const void* a, const void* b) {
+    uint64_t x = ((const IMSDL_StartupStage*) a)->start_ns;
+    uint64_t y = ((const IMSDL_StartupStage*) b)->start_ns;
+    return (x > y) - (x < y);
+}
+
+void imsdl_startup_log(void) {
+    IMSDL_StartupStage stages[IMSDL_STARTUP_STAGES];
+    pthread_mutex_lock(&imsdl_startup_lock);
+    size_t count = imsdl_startup_stage_count;
+    for (size_t i = 0; i < count; i++) {
+        stages[i] = imsdl_startup_stages[i];
+    }
+    imsdl_startup_stage_count = 0;
+    pthread_mutex_unlock(&imsdl_startup_lock);
+
+    if (count == 0) {
+        return;
+    }
+    qsort(stages, count, sizeof(IMSDL_StartupStage), imsdl_startup_compare);
+
+    uint64_t first = stages[0].start_ns;
+    uint64_t last = 0;
+    for (size_t i = 0; i < count; i++) {
+        LOG_INFO(
+            "Startup %-16s at %8.3fms took %8.3fms",
+            stages[i].name,
+            (double) (stages[i].start_ns - first) / 1e6,
+            (double) (stages[i].end_ns - stages[i].start_ns) / 1e6
+        );
+        if (stages[i].end_ns > last) {
+            last = stages[i].end_ns;
+        }
+    }
+    LOG_INFO("Startup total: %.3fms", (double) (last - first) / 1e6);
+}
+
+// --- Shaders ---
+
+/**
+ * @brief Prepares every program, then reads the program cache ahead.
+ */
+static void* imsdl_startup_shaders_thread(void* arg) {
+    IMSDL_StartupShaders* shaders = (IMSDL_StartupShaders*) arg;
+
+    uint64_t start = profile_now_ns();
+    for (size_t i = 0; i < shaders->count; i++) {
+        shaders->prepared[i] = imsdl_prepare_shader_program(
+            &shaders->sources[i], shaders->names[i][0], shaders->names[i][1]
+        );
+    }
+    imsdl_startup_record("shader_sources", start);
+
+    start = profile_now_ns();
+    imsdl_prefetch_shader_cache();
+    imsdl_startup_record("shader_cache", start);
+    return NULL;
+}
+
+void imsdl_startup_shaders_begin(
+    IMSDL_StartupShaders* shaders, const char* const (*names)[2], size_t count
+) {
+    if (count > IMSDL_STARTUP_PROGRAMS) {
+        LOG_WARN("Only preparing %d of %zu startup programs.", IMSDL_STARTUP_PROGRAMS, count);
+        count = IMSDL_STARTUP_PROGRAMS;
+    }
+    shaders->count = count;
+    shaders->names = names;
+    for (size_t i = 0; i < count; i++) {
+        shaders->prepared[i] = false;
+    }
+
+    shaders->threaded
+        = pthread_create(&shaders->thread, NULL, imsdl_startup_shaders_thread, shaders) == 0;
+    if (!shaders->threaded) {
+        LOG_WARN("Failed to start shader worker, preparing shaders inline.");
+        imsdl_startup_shaders_thread(shaders);
+    }
+}
+
+bool imsdl_startup_shaders_end(IMSDL_StartupShaders* shaders, GLuint* programs) {
+    uint64_t start = profile_now_ns();
+    if (shaders->threaded) {
+        pthread_join(shaders->thread, NULL);
+        shaders->threaded = false;
+    }
+    imsdl_startup_record("shader_wait", start);
+
+    // Submit everything first; waiting on one program no longer holds up the next
+    bool ok = true;
+    if (programs) {
+        start = profile_now_ns();
+        IMSDL_ShaderBuild builds[IMSDL_STARTUP_PROGRAMS];
+        for (size_t i = 0; i < shaders->count; i++) {
+            if (shaders->prepared[i]) {
+                imsdl_begin_shader_program(&builds[i], &shaders->sources[i]);
+            }
+        }
+        for (size_t i = 0; i < shaders->count; i++) {
+            programs[i] = shaders->prepared[i] ? imsdl_end_shader_program(&builds[i]) : 0;
+            ok = ok && programs[i] != 0;
+        }
+        imsdl_startup_record("shader_programs", start);
+    }
+
+    for (size_t i = 0; i < shaders->count; i++) {
+        if (shaders->prepared[i]) {
+            imsdl_release_shader_program(&shaders->sources[i]);
+            shaders->prepared[i] = false;
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file src/stream.c
+ * @brief Streaming buffer for geometry that changes every frame.
+ */
+
+#include "logger.h"
+#include "stream.h"
+
+#include <string.h>
+
+// Region sizes are rounded to this so region offsets suit any binding
+#define IMSDL_STREAM_REGION_ALIGNMENT 256
+
+// How long a single fence wait may block before it is retried, in nanoseconds
+#define IMSDL_STREAM_WAIT_TIMEOUT 1000000000ull
+
+/**
+ * @brief Waits until the GPU has finished reading a region.
+ */
+static void imsdl_stream_wait(IMSDL_StreamBuffer* stream, uint32_t region) {
+    GLsync fence = stream->fences[region];
+    if (!fence) {
+        return;
+    }
+
+    for (;;) {
+        GLenum result
+            = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, IMSDL_STREAM_WAIT_TIMEOUT);
+        if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) {
+            break;
+        }
+        if (result == GL_WAIT_FAILED) {
+            LOG_ERROR("Stream fence wait failed for region %u.", region);
+            break;
+        }
+    }
+
+    glDeleteSync(fence);
+    stream->fences[region] = NULL;
+}
+
+/**
+ * @brief Allocates and persistently maps the buffer storage.
+ */
+static bool imsdl_stream_allocate(IMSDL_StreamBuffer* stream, size_t region_size) {
+    region_size = (region_size + IMSDL_STREAM_REGION_ALIGNMENT - 1)
+                  & ~(size_t) (IMSDL_STREAM_REGION_ALIGNMENT - 1);
+    GLsizeiptr size = (GLsizeiptr) (region_size * IMSDL_STREAM_REGIONS);
+
+    // Buffer storage is core since 4.4 and the viewport creates a 4.5 core context
+    if (!GLEW_VERSION_4_4 && !GLEW_ARB_buffer_storage) {
+        LOG_ERROR("Stream buffer requires GL 4.4 or ARB_buffer_storage.");
+        return false;
+    }
+
+    glGenBuffers(1, &stream->buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stream->buffer);
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+    stream->mapped = (uint8_t*) glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+    if (!stream->mapped) {
+        LOG_ERROR("Failed to map stream buffer (size=%zu).", (size_t) size);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        glDeleteBuffers(1, &stream->buffer);
+        stream->buffer = 0;
+        return false;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    stream->region_size = region_size;
+    stream->offset = 0;
+    stream->region = 0;
+    return true;
+}
+
+/**
+ * @brief Unmaps and deletes the buffer storage once the GPU is done with it.
+ */
+static void imsdl_stream_release(IMSDL_StreamBuffer* stream) {
+    for (uint32_t i = 0; i < IMSDL_STREAM_REGIONS; i++) {
+        imsdl_stream_wait(stream, i);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stream->buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    stream->mapped = NULL;
+    glDeleteBuffers(1, &stream->buffer);
+    stream->buffer = 0;
+}
+
+IMSDL_StreamBuffer* imsdl_stream_create(size_t region_size) {
+    if (region_size == 0) {
+        region_size = IMSDL_STREAM_REGION_SIZE;
+    }
+
+    IMSDL_StreamBuffer* stream = (IMSDL_StreamBuffer*) malloc(sizeof(IMSDL_StreamBuffer));
+    if (!stream) {
+        LOG_ERROR("Failed to allocate memory for stream buffer.");
+        return NULL;
+    }
+
+    memset(stream->fences, 0, sizeof(stream->fences));
+    if (!imsdl_stream_allocate(stream, region_size)) {
+        free(stream);
+        return NULL;
+    }
+
+    LOG_DEBUG(
+        "Stream buffer: %u regions of %zu bytes.", IMSDL_STREAM_REGIONS, stream->region_size
+    );
+    return stream;
+}
+
+void imsdl_stream_free(IMSDL_StreamBuffer* stream) {
+    if (stream) {
+        imsdl_stream_release(stream);
+        free(stream);
+    }
+}
+
+bool imsdl_stream_begin(IMSDL_StreamBuffer* stream, size_t size) {
+    if (size > stream->region_size) {
+        // Grow geometrically so a slowly growing UI does not reallocate every frame
+        size_t region_size = stream->region_size;
+        while (region_size < size) {
+            region_size *= 2;
+        }
+
+        LOG_DEBUG(
+            "Growing stream regions from %zu to %zu bytes.", stream->region_size, region_size
+        );
+        // Allocate first so a failure leaves the current buffer intact
+        IMSDL_StreamBuffer grown;
+        memset(grown.fences, 0, sizeof(grown.fences));
+        if (!imsdl_stream_allocate(&grown, region_size)) {
+            return false;
+        }
+        imsdl_stream_release(stream);
+        *stream = grown;
+    }
+
+    stream->region = (stream->region + 1) % IMSDL_STREAM_REGIONS;
+    stream->offset = 0;
+    imsdl_stream_wait(stream, stream->region);
+    return true;
+}
+
+size_t imsdl_stream_push(
+    IMSDL_StreamBuffer* stream, const void* data, size_t size, size_t alignment
+) {
+    size_t offset = (stream->offset + alignment - 1) & ~(alignment - 1);
+    if (offset > stream->region_size || size > stream->region_size - offset) {
+        LOG_ERROR(
+            "Stream region full (size=%zu, offset=%zu, region=%zu).",
+            size,
+            stream->offset,
+            stream->region_size
+        );
+        return SIZE_MAX;
+    }
+
+    size_t position = stream->region * stream->region_size + offset;
+    memcpy(stream->mapped + position, data, size);
+
+    stream->offset = offset + size;
+    return position;
+}
+
+void imsdl_stream_end(IMSDL_StreamBuffer* stream) {
+    stream->fences[stream->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
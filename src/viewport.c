@@ -6,23 +6,226 @@
 
 #include "viewport.h"
 #include "logger.h"
+#include "profile.h"
+#include "startup.h"
+
+// --- GL State Cache ---
+
+/**
+ * @brief Forget all cached GL state, keeping the counters
+ */
+void imsdl_gl_invalidate(IMSDL_Viewport* viewport) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    uint64_t issued = state->issued;
+    uint64_t elided = state->elided;
+
+    // Every field reads as IMSDL_GL_UNKNOWN, or -1 for signed ones
+    memset(state, 0xFF, sizeof(*state));
+    state->issued = issued;
+    state->elided = elided;
+}
+
+/**
+ * @brief Bind a draw and read framebuffer unless it is already bound
+ */
+void imsdl_gl_bind_framebuffer(IMSDL_Viewport* viewport, GLuint framebuffer) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    if (state->framebuffer == framebuffer) {
+        state->elided++;
+        return;
+    }
+    state->framebuffer = framebuffer;
+    state->issued++;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+/**
+ * @brief Bind a program unless it is already bound
+ */
+void imsdl_gl_use_program(IMSDL_Viewport* viewport, GLuint program) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    if (state->program == program) {
+        state->elided++;
+        return;
+    }
+    state->program = program;
+    state->issued++;
+    glUseProgram(program);
+}
+
+/**
+ * @brief Bind a vertex array unless it is already bound
+ */
+void imsdl_gl_bind_vertex_array(IMSDL_Viewport* viewport, GLuint vertex_array) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    if (state->vertex_array == vertex_array) {
+        state->elided++;
+        return;
+    }
+    state->vertex_array = vertex_array;
+    state->element_buffer = IMSDL_GL_UNKNOWN;
+    state->issued++;
+    glBindVertexArray(vertex_array);
+}
+
+/**
+ * @brief Bind an array or element buffer unless it is already bound
+ */
+void imsdl_gl_bind_buffer(IMSDL_Viewport* viewport, GLenum target, GLuint buffer) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    GLuint* cached = NULL;
+    if (target == GL_ARRAY_BUFFER) {
+        cached = &state->array_buffer;
+    } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        cached = &state->element_buffer;
+    }
+
+    if (cached && *cached == buffer) {
+        state->elided++;
+        return;
+    }
+    if (cached) {
+        *cached = buffer;
+    }
+    state->issued++;
+    glBindBuffer(target, buffer);
+}
+
+/**
+ * @brief Bind a 2D texture to a unit unless it is already bound there
+ */
+void imsdl_gl_bind_texture(IMSDL_Viewport* viewport, GLuint unit, GLuint texture) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    if (unit < IMSDL_GL_TEXTURE_UNITS && state->textures[unit] == texture) {
+        state->elided++;
+        return;
+    }
+
+    if (state->active_texture != GL_TEXTURE0 + unit) {
+        state->active_texture = GL_TEXTURE0 + unit;
+        state->issued++;
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    if (unit < IMSDL_GL_TEXTURE_UNITS) {
+        state->textures[unit] = texture;
+    }
+    state->issued++;
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+/**
+ * @brief Set blending unless it is already set
+ */
+void imsdl_gl_blend(IMSDL_Viewport* viewport, bool enabled, GLenum src, GLenum dst) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    GLuint blend = enabled ? GL_TRUE : GL_FALSE;
+
+    if (state->blend == blend) {
+        state->elided++;
+    } else {
+        state->blend = blend;
+        state->issued++;
+        if (enabled) {
+            glEnable(GL_BLEND);
+        } else {
+            glDisable(GL_BLEND);
+        }
+    }
+
+    if (!enabled) {
+        return;
+    }
+    if (state->blend_src == src && state->blend_dst == dst) {
+        state->elided++;
+        return;
+    }
+    state->blend_src = src;
+    state->blend_dst = dst;
+    state->issued++;
+    glBlendFunc(src, dst);
+}
+
+/**
+ * @brief Set the scissor test and box unless they are already set
+ */
+void imsdl_gl_scissor(IMSDL_Viewport* viewport, bool enabled, GLint x, GLint y, GLint w, GLint h) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    GLuint scissor = enabled ? GL_TRUE : GL_FALSE;
+
+    if (state->scissor == scissor) {
+        state->elided++;
+    } else {
+        state->scissor = scissor;
+        state->issued++;
+        if (enabled) {
+            glEnable(GL_SCISSOR_TEST);
+        } else {
+            glDisable(GL_SCISSOR_TEST);
+        }
+    }
+
+    if (!enabled) {
+        return;
+    }
+    GLint* box = state->scissor_box;
+    if (box[0] == x && box[1] == y && box[2] == w && box[3] == h) {
+        state->elided++;
+        return;
+    }
+    box[0] = x;
+    box[1] = y;
+    box[2] = w;
+    box[3] = h;
+    state->issued++;
+    glScissor(x, y, w, h);
+}
+
+/**
+ * @brief Set the viewport rectangle unless it is already set
+ */
+void imsdl_gl_viewport(IMSDL_Viewport* viewport, GLint x, GLint y, GLint w, GLint h) {
+    IMSDL_Viewport_State* state = &viewport->gl.state;
+    GLint* box = state->viewport;
+    if (box[0] == x && box[1] == y && box[2] == w && box[3] == h) {
+        state->elided++;
+        return;
+    }
+    box[0] = x;
+    box[1] = y;
+    box[2] = w;
+    box[3] = h;
+    state->issued++;
+    glViewport(x, y, w, h);
+}
 
 /**
  * @brief Initialize SDL Window
  */
-void imsdl_init_sdl_window(IMSDL_Viewport* viewport) {
+bool imsdl_init_sdl_window(IMSDL_Viewport* viewport) {
+    // Without a display, prefer the offscreen driver; SDL_VIDEODRIVER still takes precedence
+    if (viewport->view.headless) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+    }
+
     // Initialize SDL Video subsystem
+    uint64_t start = profile_now_ns();
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         LOG_ERROR("SDL_Init Error: %s", SDL_GetError());
-        exit(EXIT_FAILURE);
+        return false;
     }
+    imsdl_startup_record("sdl_init", start);
 
     // Set window flags
-    if (viewport->view.flags == 0) {
+    if (viewport->view.headless) {
+        viewport->view.flags = SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN;
+    } else if (viewport->view.flags == 0 && viewport->backend == IMSDL_BACKEND_SOFTWARE) {
+        viewport->view.flags = SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE;
+    } else if (viewport->view.flags == 0) {
         viewport->view.flags = SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE;
     }
 
     // Create window with specified flags and dimensions
+    start = profile_now_ns();
     viewport->view.window = SDL_CreateWindow(
         viewport->view.title,
         SDL_WINDOWPOS_CENTERED,
@@ -35,82 +238,187 @@ void imsdl_init_sdl_window(IMSDL_Viewport* viewport) {
     // Check if window creation failed
     if (!viewport->view.window) {
         LOG_ERROR("SDL_CreateWindow Error: %s", SDL_GetError());
-        exit(EXIT_FAILURE);
+        return false;
     }
+    imsdl_startup_record("window", start);
+    return true;
 }
 
 /**
  * @brief Initialize OpenGL Context
  */
-void imsdl_init_opengl_context(IMSDL_Viewport* viewport) {
+bool imsdl_init_opengl_context(IMSDL_Viewport* viewport) {
     // Set OpenGL version and profile
     /// @note I think hardcoding the versions is a bad idea.
+    /// @note 4.5 is the newest core profile Mesa's llvmpipe offers for headless runs.
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4);
-    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 6);
+    SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 5);
     SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE);
 
     // Create OpenGL context
+    uint64_t start = profile_now_ns();
     viewport->gl.context = SDL_GL_CreateContext(viewport->view.window);
     if (!viewport->gl.context) {
         LOG_ERROR("SDL_GL_CreateContext Error: %s", SDL_GetError());
-        exit(EXIT_FAILURE);
+        return false;
     }
+    imsdl_startup_record("gl_context", start);
 
     // Initialize GLEW
+    start = profile_now_ns();
     glewExperimental = GL_TRUE;
     GLenum glewResult = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLX builds of GLEW load core entry points before failing on an EGL context
+    if (glewResult == GLEW_ERROR_NO_GLX_DISPLAY && viewport->view.headless) {
+        glewResult = GLEW_OK;
+    }
+#endif
     if (glewResult != GLEW_OK) {
         LOG_ERROR("GLEW Initialization Error: %s", glewGetErrorString(glewResult));
-        exit(EXIT_FAILURE);
+        return false;
     }
 
     // Check if GLEW loaded necessary functions
     if (!GLEW_VERSION_2_0) {
-        printf("OpenGL 2.0+ is required but not supported!\n");
-        exit(1);
+        LOG_ERROR("OpenGL 2.0+ is required but not supported!");
+        return false;
+    }
+    imsdl_startup_record("glew", start);
+
+    // Let the driver compile shaders on as many threads as it likes
+    if (GLEW_KHR_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
     }
 
     // Set swap interval for vsync
     SDL_GL_SetSwapInterval(viewport->gl.swap_interval);
 
-    // Enable depth testing
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Start tracking state from a clean slate for this context
+    viewport->gl.state.issued = 0;
+    viewport->gl.state.elided = 0;
+    imsdl_gl_invalidate(viewport);
+
+    // Enable alpha blending
+    imsdl_gl_blend(viewport, true, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Get error code after initialization
     int error_code = glGetError();
     if (error_code != GL_NO_ERROR) {
         LOG_ERROR("OpenGL Error: %d", error_code);
-        exit(EXIT_FAILURE);
+        return false;
     }
+    return true;
 }
 
 /**
- * @brief Initialize Vertex Buffer
+ * @brief Initialize Offscreen Framebuffer
  */
-void imsdl_init_opengl_vertex_buffer(
-    IMSDL_Viewport* viewport, float* vertices, size_t vertex_size
-) {
+bool imsdl_init_opengl_framebuffer(IMSDL_Viewport* viewport) {
+    glGenRenderbuffers(1, &viewport->gl.color_buffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, viewport->gl.color_buffer);
+    glRenderbufferStorage(
+        GL_RENDERBUFFER, GL_RGBA8, viewport->view.width, viewport->view.height
+    );
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &viewport->gl.framebuffer);
+    imsdl_gl_bind_framebuffer(viewport, viewport->gl.framebuffer);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, viewport->gl.color_buffer
+    );
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        LOG_ERROR("Offscreen framebuffer incomplete: 0x%x", status);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Initialize Draw List Buffers
+ */
+bool imsdl_init_opengl_draw_buffers(IMSDL_Viewport* viewport) {
+    // Vertices and indices share one stream buffer, rewritten every frame
+    viewport->gl.stream = imsdl_stream_create(0);
+    if (!viewport->gl.stream) {
+        LOG_ERROR("Failed to create stream buffer.");
+        return false;
+    }
+
+    viewport->gl.capture = imsdl_capture_create();
+    if (!viewport->gl.capture) {
+        LOG_ERROR("Failed to create capture queue.");
+        return false;
+    }
+
+    // Attribute formats are fixed; imsdl_render binds the frame's region to binding 0
     glGenVertexArrays(1, &viewport->gl.vao);
-    glBindVertexArray(viewport->gl.vao);
+    imsdl_gl_bind_vertex_array(viewport, viewport->gl.vao);
+    glEnableVertexAttribArray(0);
+    glVertexAttribFormat(0, 2, GL_FLOAT, GL_FALSE, offsetof(IMSDL_Vertex, x));
+    glVertexAttribBinding(0, 0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribFormat(1, 2, GL_FLOAT, GL_FALSE, offsetof(IMSDL_Vertex, u));
+    glVertexAttribBinding(1, 0);
+    glEnableVertexAttribArray(2);
+    glVertexAttribFormat(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(IMSDL_Vertex, color));
+    glVertexAttribBinding(2, 0);
 
-    glGenBuffers(1, &viewport->gl.vbo);
-    glBindBuffer(GL_ARRAY_BUFFER, viewport->gl.vbo);
-    glBufferData(GL_ARRAY_BUFFER, vertex_size, vertices, GL_STATIC_DRAW);
+    // Rects: a unit quad on binding 0, instances on binding 1 advancing once per instance
+    static const GLfloat corners[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+    glGenBuffers(1, &viewport->gl.quad_vbo);
+    imsdl_gl_bind_buffer(viewport, GL_ARRAY_BUFFER, viewport->gl.quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
 
+    glGenVertexArrays(1, &viewport->gl.rect_vao);
+    imsdl_gl_bind_vertex_array(viewport, viewport->gl.rect_vao);
+    glBindVertexBuffer(0, viewport->gl.quad_vbo, 0, 2 * sizeof(GLfloat));
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*) 0);
+    glVertexAttribFormat(0, 2, GL_FLOAT, GL_FALSE, 0);
+    glVertexAttribBinding(0, 0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribFormat(1, 4, GL_FLOAT, GL_FALSE, offsetof(IMSDL_RectInstance, x0));
+    glVertexAttribBinding(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, offsetof(IMSDL_RectInstance, radius));
+    glVertexAttribBinding(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribFormat(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(IMSDL_RectInstance, fill));
+    glVertexAttribBinding(3, 1);
+    glEnableVertexAttribArray(4);
+    glVertexAttribFormat(
+        4, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(IMSDL_RectInstance, border_color)
+    );
+    glVertexAttribBinding(4, 1);
+    glVertexBindingDivisor(1, 1);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    // Untextured primitives sample a single white texel
+    const uint32_t white = IMSDL_RGBA(255, 255, 255, 255);
+    glGenTextures(1, &viewport->gl.white_texture);
+    imsdl_gl_bind_texture(viewport, 0, viewport->gl.white_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &white);
+    return true;
 }
 
 /**
- * @brief Create Viewport
+ * @brief Create a Windowed or Headless Viewport
  */
-IMSDL_Viewport* imsdl_create_viewport(const char* title, int width, int height, int flags) {
-    // Allocate memory for viewport structure
-    IMSDL_Viewport* viewport = (IMSDL_Viewport*) malloc(sizeof(IMSDL_Viewport));
+static IMSDL_Viewport* imsdl_create_viewport_internal(
+    const char* title,
+    int width,
+    int height,
+    int flags,
+    bool headless,
+    IMSDL_Viewport_Backend backend
+) {
+    // Zeroed so imsdl_destroy_viewport can unwind a partially initialized viewport
+    IMSDL_Viewport* viewport = (IMSDL_Viewport*) calloc(1, sizeof(IMSDL_Viewport));
     if (!viewport) {
         LOG_ERROR("Failed to allocate memory for viewport.");
         return NULL;
@@ -121,57 +429,416 @@ IMSDL_Viewport* imsdl_create_viewport(const char* title, int width, int height,
     viewport->view.width = width;
     viewport->view.height = height;
     viewport->view.flags = flags;
+    viewport->view.headless = headless;
+    viewport->backend = backend;
     viewport->color = (IMSDL_Viewport_Color) {0.1f, 0.1f, 0.1f, 1.0f};
     viewport->gl.swap_interval = 1;
+    // Headless viewports get no input, so waiting for events would block forever
+    viewport->run_mode = headless ? IMSDL_RUN_CONTINUOUS : IMSDL_RUN_ON_DEMAND;
+    viewport->needs_redraw = true; // The first frame always draws
+    viewport->redraw_deadline = 0;
+    viewport->capture_requested = false;
+
+    viewport->frame = frame_arena_create(IMSDL_FRAME_ARENA_SIZE, 0);
+    if (!viewport->frame) {
+        LOG_ERROR("Failed to create frame arena.");
+        free(viewport);
+        return NULL;
+    }
+
+    viewport->draw = imsdl_draw_list_create(0);
+    if (!viewport->draw) {
+        LOG_ERROR("Failed to create draw list.");
+        frame_arena_free(viewport->frame);
+        free(viewport);
+        return NULL;
+    }
+
+    if (backend == IMSDL_BACKEND_SOFTWARE) {
+        viewport->raster = imsdl_raster_create(-1);
+        if (!viewport->raster || !imsdl_init_sdl_window(viewport)) {
+            imsdl_destroy_viewport(viewport);
+            return NULL;
+        }
+        return viewport;
+    }
 
-    imsdl_init_sdl_window(viewport);
-    imsdl_init_opengl_context(viewport);
+    if (!imsdl_init_sdl_window(viewport) || !imsdl_init_opengl_context(viewport)) {
+        imsdl_destroy_viewport(viewport);
+        return NULL;
+    }
+
+    uint64_t start = profile_now_ns();
+    if ((headless && !imsdl_init_opengl_framebuffer(viewport))
+        || !imsdl_init_opengl_draw_buffers(viewport)) {
+        imsdl_destroy_viewport(viewport);
+        return NULL;
+    }
+    imsdl_startup_record("gl_resources", start);
 
     return viewport;
 }
 
+/**
+ * @brief Create Viewport
+ */
+IMSDL_Viewport* imsdl_create_viewport(const char* title, int width, int height, int flags) {
+    return imsdl_create_viewport_internal(
+        title, width, height, flags, false, IMSDL_BACKEND_OPENGL
+    );
+}
+
+/**
+ * @brief Create Headless Viewport
+ */
+IMSDL_Viewport* imsdl_create_headless_viewport(const char* title, int width, int height) {
+    return imsdl_create_viewport_internal(title, width, height, 0, true, IMSDL_BACKEND_OPENGL);
+}
+
+/**
+ * @brief Create Software Viewport
+ */
+IMSDL_Viewport* imsdl_create_software_viewport(
+    const char* title, int width, int height, int flags
+) {
+    return imsdl_create_viewport_internal(
+        title, width, height, flags, false, IMSDL_BACKEND_SOFTWARE
+    );
+}
+
 /**
  * @brief Destroy Viewport
  */
 void imsdl_destroy_viewport(IMSDL_Viewport* viewport) {
     if (viewport) {
-        glDeleteVertexArrays(1, &viewport->gl.vao);
-        glDeleteBuffers(1, &viewport->gl.vbo);
+        // GL objects can only exist, and GL can only be called, with a context
+        if (viewport->gl.context) {
+            glDeleteVertexArrays(1, &viewport->gl.vao);
+            glDeleteVertexArrays(1, &viewport->gl.rect_vao);
+            glDeleteBuffers(1, &viewport->gl.quad_vbo);
+            imsdl_stream_free(viewport->gl.stream);
+            imsdl_capture_free(viewport->gl.capture);
+            glDeleteTextures(1, &viewport->gl.white_texture);
+            glDeleteFramebuffers(1, &viewport->gl.framebuffer);
+            glDeleteRenderbuffers(1, &viewport->gl.color_buffer);
+            PROFILE_GPU_SHUTDOWN();
+            SDL_GL_DeleteContext(viewport->gl.context);
+        }
 
-        SDL_GL_DeleteContext(viewport->gl.context);
-        SDL_DestroyWindow(viewport->view.window);
+        if (viewport->view.window) {
+            SDL_DestroyWindow(viewport->view.window);
+        }
+        imsdl_raster_free(viewport->raster);
         SDL_Quit();
 
+        imsdl_draw_list_free(viewport->draw);
+        frame_arena_free(viewport->frame);
         free(viewport);
     }
 }
 
 /**
- * @brief Render Function
+ * @brief Rasterize the Draw List into the Window Surface
  */
-void imsdl_render(IMSDL_Viewport* viewport, GLuint shader_program) {
+static void imsdl_render_software(IMSDL_Viewport* viewport) {
+    // The surface is recreated on resize, so fetch it every frame
+    SDL_Surface* surface = SDL_GetWindowSurface(viewport->view.window);
+    if (!surface) {
+        LOG_ERROR_RATELIMIT(1000, "SDL_GetWindowSurface Error: %s", SDL_GetError());
+        return;
+    }
+    if (surface->format->BytesPerPixel != 4
+        || (surface->format->Rshift != 0 && surface->format->Rshift != 16)) {
+        LOG_ERROR_RATELIMIT(1000, "Unsupported window surface format.");
+        return;
+    }
+
+    viewport->view.width = surface->w;
+    viewport->view.height = surface->h;
+    viewport->raster->swap_rb = surface->format->Rshift == 16;
+
+    IMSDL_Viewport_Color color = viewport->color;
+    uint32_t clear = IMSDL_RGBA(
+        (uint32_t) (color.r * 255.0f + 0.5f),
+        (uint32_t) (color.g * 255.0f + 0.5f),
+        (uint32_t) (color.b * 255.0f + 0.5f),
+        (uint32_t) (color.a * 255.0f + 0.5f)
+    );
+
+    if (SDL_MUSTLOCK(surface) && SDL_LockSurface(surface) != 0) {
+        LOG_ERROR_RATELIMIT(1000, "SDL_LockSurface Error: %s", SDL_GetError());
+        return;
+    }
+    PROFILE_ZONE_BEGIN(raster);
+    imsdl_raster_render(
+        viewport->raster,
+        viewport->draw,
+        (uint32_t*) surface->pixels,
+        (size_t) surface->pitch / sizeof(uint32_t),
+        surface->w,
+        surface->h,
+        clear
+    );
+    PROFILE_ZONE_END(raster);
+    if (SDL_MUSTLOCK(surface)) {
+        SDL_UnlockSurface(surface);
+    }
+    SDL_UpdateWindowSurface(viewport->view.window);
+}
+
+/**
+ * @brief Submit the Draw List to OpenGL and Present It
+ */
+static void imsdl_render_opengl(
+    IMSDL_Viewport* viewport, GLuint shader_program, GLuint rect_program
+) {
+    IMSDL_DrawList* draw = viewport->draw;
+
+    // Track resizes; draw list coordinates are in window units
+    int drawable_width, drawable_height;
+    if (viewport->view.headless) {
+        // The offscreen framebuffer keeps the size it was created with
+        drawable_width = viewport->view.width;
+        drawable_height = viewport->view.height;
+    } else {
+        SDL_GL_GetDrawableSize(viewport->view.window, &drawable_width, &drawable_height);
+        SDL_GetWindowSize(viewport->view.window, &viewport->view.width, &viewport->view.height);
+    }
+    imsdl_gl_bind_framebuffer(viewport, viewport->gl.framebuffer);
+    imsdl_gl_viewport(viewport, 0, 0, drawable_width, drawable_height);
+
+    // Timed from the clear to the last draw; the result is read a few frames later
+    PROFILE_GPU_BEGIN();
     glClearColor(viewport->color.r, viewport->color.g, viewport->color.b, viewport->color.a);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glUseProgram(shader_program);
-    glBindVertexArray(viewport->gl.vao);
-    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
-    glBindVertexArray(0);
-    glUseProgram(0);
+    if (draw->command_count > 0) {
+        // Copy the frame into its stream region; the list is written sequentially,
+        // which suits write-combined memory better than building it there in place
+        IMSDL_StreamBuffer* stream = viewport->gl.stream;
+        size_t vertex_size = (size_t) draw->vertex_count * sizeof(IMSDL_Vertex);
+        size_t index_size = (size_t) draw->index_count * sizeof(IMSDL_Index);
+        size_t rect_size = (size_t) draw->rect_count * sizeof(IMSDL_RectInstance);
+        size_t vertex_offset = SIZE_MAX;
+        size_t index_offset = SIZE_MAX;
+        size_t rect_offset = SIZE_MAX;
+        PROFILE_ZONE_BEGIN(upload);
+        size_t region_size = stream->region_size;
+        bool begun = imsdl_stream_begin(stream, vertex_size + index_size + rect_size + 48);
+        if (stream->region_size != region_size) {
+            // Growing recreates the buffer, possibly under the same name
+            imsdl_gl_invalidate(viewport);
+        }
+        if (begun) {
+            const IMSDL_Vertex* vertices = imsdl_draw_list_vertices(draw);
+            const IMSDL_Index* indices = imsdl_draw_list_indices(draw);
+            const IMSDL_RectInstance* rects = imsdl_draw_list_rects(draw);
+            vertex_offset = imsdl_stream_push(stream, vertices, vertex_size, 16);
+            index_offset = imsdl_stream_push(stream, indices, index_size, 16);
+            rect_offset = imsdl_stream_push(stream, rects, rect_size, 16);
+        }
+        PROFILE_ZONE_END(upload);
+
+        if (vertex_offset != SIZE_MAX && index_offset != SIZE_MAX && rect_offset != SIZE_MAX) {
+            // Map window coordinates with a top-left origin to clip space
+            float w = (float) viewport->view.width;
+            float h = (float) viewport->view.height;
+            const GLfloat projection[16] = {
+                2.0f / w, 0.0f, 0.0f, 0.0f, // Column 0
+                0.0f, -2.0f / h, 0.0f, 0.0f, // Column 1
+                0.0f, 0.0f, -1.0f, 0.0f, // Column 2
+                -1.0f, 1.0f, 0.0f, 1.0f, // Column 3
+            };
+            glProgramUniformMatrix4fv(
+                shader_program, IMSDL_UNIFORM_PROJECTION, 1, GL_FALSE, projection
+            );
+            glProgramUniformMatrix4fv(
+                rect_program, IMSDL_UNIFORM_PROJECTION, 1, GL_FALSE, projection
+            );
+
+            // Point both layouts at this frame's region; offsets change every frame
+            imsdl_gl_bind_vertex_array(viewport, viewport->gl.vao);
+            glBindVertexBuffer(0, stream->buffer, (GLintptr) vertex_offset, sizeof(IMSDL_Vertex));
+            imsdl_gl_bind_buffer(viewport, GL_ELEMENT_ARRAY_BUFFER, stream->buffer);
+            imsdl_gl_bind_vertex_array(viewport, viewport->gl.rect_vao);
+            glBindVertexBuffer(
+                1, stream->buffer, (GLintptr) rect_offset, sizeof(IMSDL_RectInstance)
+            );
+
+            // Commands run in submission order; bindings stay in place between frames
+            PROFILE_ZONE_BEGIN(submit);
+            const IMSDL_DrawCommand* commands = imsdl_draw_list_commands(draw);
+            for (uint32_t i = 0; i < draw->command_count; i++) {
+                const IMSDL_DrawCommand* command = &commands[i];
+                if (command->kind == IMSDL_DRAW_RECTS) {
+                    imsdl_gl_use_program(viewport, rect_program);
+                    imsdl_gl_bind_vertex_array(viewport, viewport->gl.rect_vao);
+                    glDrawArraysInstancedBaseInstance(
+                        GL_TRIANGLE_STRIP, 0, 4, (GLsizei) command->count, command->offset
+                    );
+                } else {
+                    GLuint texture = command->texture;
+                    size_t offset = index_offset + command->offset * sizeof(IMSDL_Index);
+                    imsdl_gl_use_program(viewport, shader_program);
+                    imsdl_gl_bind_vertex_array(viewport, viewport->gl.vao);
+                    imsdl_gl_bind_texture(
+                        viewport, 0, texture ? texture : viewport->gl.white_texture
+                    );
+                    glDrawElements(
+                        GL_TRIANGLES, (GLsizei) command->count, GL_UNSIGNED_INT, (void*) offset
+                    );
+                }
+                PROFILE_COUNT(PROFILE_COUNTER_DRAW_CALLS, 1);
+            }
+            PROFILE_ZONE_END(submit);
+        }
+
+        if (begun) {
+            // Keep the region from being rewritten until these draws complete
+            imsdl_stream_end(stream);
+        }
+    }
+    PROFILE_GPU_END();
+
+    // Read back before the swap, after which the window's back buffer is undefined
+    if (viewport->capture_requested) {
+        viewport->capture_requested = false;
+        imsdl_capture_queue(viewport->gl.capture, drawable_width, drawable_height);
+    }
 
-    SDL_GL_SwapWindow(viewport->view.window);
+    PROFILE_ZONE_BEGIN(present);
+    if (viewport->view.headless) {
+        glFlush(); // Nothing is presented; just submit the frame
+    } else {
+        SDL_GL_SwapWindow(viewport->view.window);
+    }
+    PROFILE_ZONE_END(present);
 }
 
 /**
- * @brief Basic Event Handling
+ * @brief Render Function
  */
-void imsdl_handle_events(int* running) {
+void imsdl_render(IMSDL_Viewport* viewport, GLuint shader_program, GLuint rect_program) {
+    PROFILE_COUNT(PROFILE_COUNTER_VERTICES, viewport->draw->vertex_count);
+    PROFILE_COUNT(PROFILE_COUNTER_INDICES, viewport->draw->index_count);
+    PROFILE_COUNT(PROFILE_COUNTER_RECTS, viewport->draw->rect_count);
+
+    PROFILE_ZONE_BEGIN(render);
+    if (viewport->backend == IMSDL_BACKEND_SOFTWARE) {
+        imsdl_render_software(viewport);
+    } else {
+        imsdl_render_opengl(viewport, shader_program, rect_program);
+    }
+    PROFILE_ZONE_END(render);
+    viewport->needs_redraw = false;
+
+    imsdl_draw_list_reset(viewport->draw);
+
+    // Release the frame before last; the frame just presented stays valid
+    frame_arena_swap(viewport->frame);
+    MEMSTAT_FRAME_END();
+    PROFILE_FRAME_END();
+}
+
+/**
+ * @brief Allocate Per-Frame Memory
+ */
+void* imsdl_frame_push(IMSDL_Viewport* viewport, size_t size, size_t alignment) {
+    return arena_push(frame_arena_current(viewport->frame), size, alignment);
+}
+
+/**
+ * @brief Request a Readback of the Next Frame
+ */
+void imsdl_request_capture(IMSDL_Viewport* viewport) {
+    viewport->capture_requested = true;
+}
+
+/**
+ * @brief Request a Redraw on the Next Iteration
+ */
+void imsdl_request_redraw(IMSDL_Viewport* viewport) {
+    viewport->needs_redraw = true;
+}
+
+/**
+ * @brief Request a Redraw After a Delay
+ *
+ * Keeps the earliest pending deadline, so several animations can each ask
+ * for their next frame and the loop wakes for whichever comes first.
+ */
+void imsdl_request_redraw_in(IMSDL_Viewport* viewport, uint32_t delay_ms) {
+    uint64_t deadline = SDL_GetTicks64() + delay_ms;
+    if (viewport->redraw_deadline == 0 || deadline < viewport->redraw_deadline) {
+        viewport->redraw_deadline = deadline;
+    }
+}
+
+/**
+ * @brief Promote a Passed Animation Deadline to a Redraw
+ */
+static void imsdl_check_redraw_deadline(IMSDL_Viewport* viewport) {
+    if (viewport->redraw_deadline && SDL_GetTicks64() >= viewport->redraw_deadline) {
+        viewport->redraw_deadline = 0;
+        viewport->needs_redraw = true;
+    }
+}
+
+/**
+ * @brief Event Handling
+ */
+bool imsdl_handle_events(
+    IMSDL_Viewport* viewport, int* running, IMSDL_EventHandler handler, void* user_data
+) {
+    imsdl_check_redraw_deadline(viewport);
+
+    // Only block when idle; a pending redraw or continuous mode just drains the queue
     SDL_Event event;
-    while (SDL_PollEvent(&event)) {
-        if (event.type == SDL_QUIT) {
-            *running = 0;
+    int pending;
+    if (viewport->run_mode == IMSDL_RUN_CONTINUOUS || viewport->needs_redraw) {
+        pending = SDL_PollEvent(&event);
+    } else if (viewport->redraw_deadline) {
+        uint64_t now = SDL_GetTicks64();
+        uint64_t timeout = viewport->redraw_deadline > now ? viewport->redraw_deadline - now : 0;
+        pending = SDL_WaitEventTimeout(&event, timeout > INT32_MAX ? INT32_MAX : (int) timeout);
+    } else {
+        pending = SDL_WaitEvent(&event);
+    }
+
+    // Time spent waiting is idle, not frame cost
+    PROFILE_FRAME_BEGIN();
+    PROFILE_ZONE_BEGIN(events);
+    while (pending) {
+        bool changed = false;
+        switch (event.type) {
+            case SDL_QUIT:
+                *running = 0;
+                break;
+            case SDL_WINDOWEVENT:
+                // Layout for this frame must see the new size, not last frame's
+                if (event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                    viewport->view.width = event.window.data1;
+                    viewport->view.height = event.window.data2;
+                }
+                // Contents are lost or resized; anything else (moves, focus) keeps them
+                changed = event.window.event == SDL_WINDOWEVENT_SHOWN
+                          || event.window.event == SDL_WINDOWEVENT_EXPOSED
+                          || event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED;
+                break;
         }
+        if (handler && handler(&event, user_data)) {
+            changed = true;
+        }
+        if (changed) {
+            viewport->needs_redraw = true;
+        }
+        pending = SDL_PollEvent(&event);
     }
+    PROFILE_ZONE_END(events);
+
+    imsdl_check_redraw_deadline(viewport);
+    return *running
+           && (viewport->run_mode == IMSDL_RUN_CONTINUOUS || viewport->needs_redraw);
 }
 
 // --- SDL, OpenGL, and Viewport Logging ---
@@ -194,6 +861,20 @@ void imsdl_log_viewport(IMSDL_Viewport* viewport) {
     LOG_INFO("Viewport Swap Interval: %d", viewport->gl.swap_interval);
 }
 
+/**
+ * @brief Log GL State Cache Counters
+ */
+void imsdl_log_gl_state(IMSDL_Viewport* viewport) {
+    const IMSDL_Viewport_State* state = &viewport->gl.state;
+    uint64_t total = state->issued + state->elided;
+    LOG_INFO(
+        "GL state changes: %llu issued, %llu elided (%.1f%%)",
+        (unsigned long long) state->issued,
+        (unsigned long long) state->elided,
+        total ? 100.0 * (double) state->elided / (double) total : 0.0
+    );
+}
+
 /**
  * @brief Log SDL and OpenGL Information
  */
@@ -0,0 +1,377 @@
+/**
+ * @file src/watch.c
+ * @brief Shader hot reload for development.
+ */
+
+#include "watch.h"
+#include "logger.h"
+#include "shaders.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+// --- Worker ---
+
+/**
+ * @brief Returns true for file names that look like shaders and fit a slot.
+ */
+static bool imsdl_shader_watch_is_shader(const char* name) {
+    size_t length = strlen(name);
+    return length > 5 && length < IMSDL_SHADER_WATCH_NAME_SIZE
+           && strcmp(name + length - 5, ".glsl") == 0;
+}
+
+/**
+ * @brief Reads a changed file and queues it for the render thread.
+ */
+static void imsdl_shader_watch_read(IMSDL_ShaderWatch* watch, const char* name) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", watch->directory, name);
+    char* text = imsdl_read_shader(path);
+    if (!text) {
+        return;
+    }
+
+    pthread_mutex_lock(&watch->lock);
+    // A newer version replaces one the render thread has not taken yet
+    IMSDL_ShaderWatchFile* file = NULL;
+    for (size_t i = 0; i < watch->file_count && !file; i++) {
+        if (strcmp(watch->files[i].name, name) == 0) {
+            file = &watch->files[i];
+        }
+    }
+    if (!file && watch->file_count < IMSDL_SHADER_WATCH_FILES) {
+        file = &watch->files[watch->file_count++];
+        snprintf(file->name, sizeof(file->name), "%s", name);
+        file->text = NULL;
+    }
+    if (file) {
+        free(file->text);
+        file->text = text;
+        text = NULL;
+    }
+    pthread_mutex_unlock(&watch->lock);
+
+    if (text) {
+        LOG_WARN("Too many changed shaders, dropping %s.", name);
+        free(text);
+    } else {
+        LOG_DEBUG("Shader %s changed.", name);
+    }
+}
+
+/**
+ * @brief Waits for inotify events until stop_fd is written.
+ */
+static void* imsdl_shader_watch_thread(void* arg) {
+    IMSDL_ShaderWatch* watch = (IMSDL_ShaderWatch*) arg;
+    _Alignas(struct inotify_event) char buffer[4096];
+    struct pollfd fds[2] = {{watch->inotify_fd, POLLIN, 0}, {watch->stop_fd, POLLIN, 0}};
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR("Shader watch poll failed: %s", strerror(errno));
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+
+        ssize_t length = read(watch->inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            continue;
+        }
+
+        bool changed = false;
+        for (const char* next = buffer; next < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*) next;
+            if (event->mask & IN_Q_OVERFLOW) {
+                LOG_WARN("Shader watch queue overflowed; some edits were missed.");
+            }
+            if (event->len > 0 && !(event->mask & IN_ISDIR)
+                && imsdl_shader_watch_is_shader(event->name)) {
+                imsdl_shader_watch_read(watch, event->name);
+                changed = true;
+            }
+            next += sizeof(struct inotify_event) + event->len;
+        }
+
+        if (changed && watch->notify) {
+            watch->notify(watch->user_data);
+        }
+    }
+    return NULL;
+}
+
+// --- Rebuilds ---
+
+/**
+ * @brief Deletes the program being built and its shaders.
+ */
+static void imsdl_shader_watch_discard(IMSDL_ShaderWatchProgram* entry) {
+    glDeleteShader(entry->vertex_shader);
+    glDeleteShader(entry->fragment_shader);
+    glDeleteProgram(entry->pending);
+    entry->pending = 0;
+    entry->vertex_shader = 0;
+    entry->fragment_shader = 0;
+}
+
+/**
+ * @brief Submits a shader for compilation without waiting for the result.
+ */
+static GLuint imsdl_shader_watch_compile(GLenum type, const IMSDL_ShaderText* text) {
+    GLuint shader = glCreateShader(type);
+    GLint length = (GLint) text->size;
+    glShaderSource(shader, 1, &text->data, &length);
+    glCompileShader(shader);
+    return shader;
+}
+
+static const IMSDL_ShaderWatchFile* imsdl_shader_watch_find(
+    const IMSDL_ShaderWatchFile* files, size_t count, const char* name
+) {
+    for (size_t i = 0; i < count; i++) {
+        if (strcmp(files[i].name, name) == 0) {
+            return &files[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Starts rebuilding entry from the changed files; unchanged shaders load as usual.
+ */
+static void imsdl_shader_watch_start(
+    IMSDL_ShaderWatchProgram* entry,
+    const IMSDL_ShaderWatchFile* vertex_file,
+    const IMSDL_ShaderWatchFile* fragment_file
+) {
+    // A newer edit supersedes a build still in progress
+    imsdl_shader_watch_discard(entry);
+
+    IMSDL_ShaderText vertex = {NULL, 0, false};
+    IMSDL_ShaderText fragment = {NULL, 0, false};
+    bool loaded = true;
+    if (vertex_file) {
+        vertex = (IMSDL_ShaderText) {vertex_file->text, strlen(vertex_file->text), false};
+    } else {
+        loaded = imsdl_load_shader(entry->vertex_name, &vertex);
+    }
+    if (fragment_file) {
+        fragment = (IMSDL_ShaderText) {fragment_file->text, strlen(fragment_file->text), false};
+    } else {
+        loaded = imsdl_load_shader(entry->fragment_name, &fragment) && loaded;
+    }
+
+    // Compile and link return at once; status is only queried when the build is done
+    if (loaded) {
+        entry->vertex_shader = imsdl_shader_watch_compile(GL_VERTEX_SHADER, &vertex);
+        entry->fragment_shader = imsdl_shader_watch_compile(GL_FRAGMENT_SHADER, &fragment);
+        entry->pending = glCreateProgram();
+        glAttachShader(entry->pending, entry->vertex_shader);
+        glAttachShader(entry->pending, entry->fragment_shader);
+        glLinkProgram(entry->pending);
+    }
+
+    imsdl_release_shader(&vertex);
+    imsdl_release_shader(&fragment);
+}
+
+/**
+ * @brief Swaps in a linked program, or logs why the build failed and keeps the old one.
+ *
+ * @return True if the owner's program was replaced.
+ */
+static bool imsdl_shader_watch_finish(IMSDL_ShaderWatchProgram* entry) {
+    GLint linked = GL_FALSE;
+    glGetProgramiv(entry->pending, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char info_log[512];
+        const GLuint shaders[] = {entry->vertex_shader, entry->fragment_shader};
+        const char* names[] = {entry->vertex_name, entry->fragment_name};
+        bool compiled = true;
+        for (int i = 0; i < 2; i++) {
+            GLint status = GL_FALSE;
+            glGetShaderiv(shaders[i], GL_COMPILE_STATUS, &status);
+            if (!status) {
+                glGetShaderInfoLog(shaders[i], sizeof(info_log), NULL, info_log);
+                LOG_ERROR("Reload of %s failed, keeping the old program: %s", names[i], info_log);
+                compiled = false;
+            }
+        }
+        if (compiled) {
+            glGetProgramInfoLog(entry->pending, sizeof(info_log), NULL, info_log);
+            LOG_ERROR(
+                "Reload of %s + %s failed to link, keeping the old program: %s",
+                names[0],
+                names[1],
+                info_log
+            );
+        }
+        imsdl_shader_watch_discard(entry);
+        return false;
+    }
+
+    // GL defers deleting the old program while it is still current
+    glDeleteProgram(*entry->program);
+    *entry->program = entry->pending;
+    entry->pending = 0;
+    imsdl_shader_watch_discard(entry);
+    LOG_INFO("Reloaded shader program %s + %s.", entry->vertex_name, entry->fragment_name);
+    return true;
+}
+
+// --- Watch ---
+
+IMSDL_ShaderWatch* imsdl_shader_watch_create(
+    const char* directory, IMSDL_ShaderWatchNotify notify, void* user_data
+) {
+    IMSDL_ShaderWatch* watch = (IMSDL_ShaderWatch*) calloc(1, sizeof(IMSDL_ShaderWatch));
+    if (!watch) {
+        LOG_ERROR("Failed to allocate memory for shader watch.");
+        return NULL;
+    }
+    watch->directory = directory;
+    watch->notify = notify;
+    watch->user_data = user_data;
+
+    watch->inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    watch->stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (watch->inotify_fd < 0 || watch->stop_fd < 0
+        || inotify_add_watch(watch->inotify_fd, directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        LOG_ERROR("Failed to watch shader directory %s: %s", directory, strerror(errno));
+        if (watch->inotify_fd >= 0) {
+            close(watch->inotify_fd);
+        }
+        if (watch->stop_fd >= 0) {
+            close(watch->stop_fd);
+        }
+        free(watch);
+        return NULL;
+    }
+
+    // imsdl_init_opengl_context already handed compiles to the driver's threads
+    watch->parallel = GLEW_KHR_parallel_shader_compile || GLEW_ARB_parallel_shader_compile;
+
+    pthread_mutex_init(&watch->lock, NULL);
+    if (pthread_create(&watch->thread, NULL, imsdl_shader_watch_thread, watch) != 0) {
+        LOG_ERROR("Failed to start shader watch thread.");
+        pthread_mutex_destroy(&watch->lock);
+        close(watch->inotify_fd);
+        close(watch->stop_fd);
+        free(watch);
+        return NULL;
+    }
+
+    LOG_INFO(
+        "Watching %s for shader changes (parallel compile: %s).",
+        directory,
+        watch->parallel ? "yes" : "no"
+    );
+    return watch;
+}
+
+void imsdl_shader_watch_free(IMSDL_ShaderWatch* watch) {
+    if (watch) {
+        uint64_t stop = 1;
+        if (write(watch->stop_fd, &stop, sizeof(stop)) != (ssize_t) sizeof(stop)) {
+            LOG_ERROR("Failed to stop shader watch thread: %s", strerror(errno));
+        } else {
+            pthread_join(watch->thread, NULL);
+        }
+        close(watch->inotify_fd);
+        close(watch->stop_fd);
+        pthread_mutex_destroy(&watch->lock);
+
+        for (size_t i = 0; i < watch->file_count; i++) {
+            free(watch->files[i].text);
+        }
+        for (size_t i = 0; i < watch->program_count; i++) {
+            imsdl_shader_watch_discard(&watch->programs[i]);
+        }
+        free(watch);
+    }
+}
+
+bool imsdl_shader_watch_add(
+    IMSDL_ShaderWatch* watch, GLuint* program, const char* vertex_name, const char* fragment_name
+) {
+    if (watch->program_count == IMSDL_SHADER_WATCH_PROGRAMS) {
+        LOG_ERROR("Shader watch full, not watching %s + %s.", vertex_name, fragment_name);
+        return false;
+    }
+
+    watch->programs[watch->program_count++]
+        = (IMSDL_ShaderWatchProgram) {program, vertex_name, fragment_name, 0, 0, 0};
+    return true;
+}
+
+bool imsdl_shader_watch_poll(IMSDL_ShaderWatch* watch) {
+    // Take the files read since the last poll; the worker keeps reading meanwhile
+    IMSDL_ShaderWatchFile files[IMSDL_SHADER_WATCH_FILES];
+    pthread_mutex_lock(&watch->lock);
+    size_t file_count = watch->file_count;
+    memcpy(files, watch->files, file_count * sizeof(IMSDL_ShaderWatchFile));
+    watch->file_count = 0;
+    pthread_mutex_unlock(&watch->lock);
+
+    bool started[IMSDL_SHADER_WATCH_PROGRAMS] = {false};
+    for (size_t i = 0; i < watch->program_count && file_count > 0; i++) {
+        IMSDL_ShaderWatchProgram* entry = &watch->programs[i];
+        const IMSDL_ShaderWatchFile* vertex_file
+            = imsdl_shader_watch_find(files, file_count, entry->vertex_name);
+        const IMSDL_ShaderWatchFile* fragment_file
+            = imsdl_shader_watch_find(files, file_count, entry->fragment_name);
+        if (vertex_file || fragment_file) {
+            imsdl_shader_watch_start(entry, vertex_file, fragment_file);
+            started[i] = true;
+        }
+    }
+    for (size_t i = 0; i < file_count; i++) {
+        free(files[i].text);
+    }
+
+    bool replaced = false;
+    for (size_t i = 0; i < watch->program_count; i++) {
+        IMSDL_ShaderWatchProgram* entry = &watch->programs[i];
+        if (!entry->pending) {
+            continue;
+        }
+
+        if (watch->parallel) {
+            // Never block; check again next frame
+            GLint done = GL_FALSE;
+            glGetProgramiv(entry->pending, GL_COMPLETION_STATUS_KHR, &done);
+            if (!done) {
+                continue;
+            }
+        } else if (started[i]) {
+            continue; // Give the driver until the next poll before the status query blocks
+        }
+
+        if (imsdl_shader_watch_finish(entry)) {
+            replaced = true;
+        }
+    }
+    return replaced;
+}
+
+bool imsdl_shader_watch_busy(const IMSDL_ShaderWatch* watch) {
+    for (size_t i = 0; i < watch->program_count; i++) {
+        if (watch->programs[i].pending) {
+            return true;
+        }
+    }
+    return false;
+}
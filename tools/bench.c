@@ -0,0 +1,717 @@
+/**
+ * @file tools/bench.c
+ * @brief Runs scripted workloads headlessly and reports timings as JSON.
+ *
+ * Usage: imsdl_bench [options] [workload...]
+ *
+ *   --software     Rasterize on the CPU instead of into an offscreen GL framebuffer
+ *   --frames N     Measured frames per workload (default 500)
+ *   --warmup N     Frames run before measuring (default 50)
+ *   --size WxH     Target size in pixels (default 1280x720)
+ *   --output FILE  Write the report to FILE instead of stdout
+ *   --list         Print the workload names and exit
+ *
+ * Every workload is seeded the same way on every run, so two reports from
+ * the same machine are directly comparable. A frame is one step of the
+ * workload plus, for rendering workloads, imsdl_render and glFinish, so
+ * frame times include the GPU. Allocator and logger workloads do not
+ * render; each of their frames is a fixed batch of operations.
+ *
+ * Allocation counts come from the allocator statistics and are reported as
+ * null unless the project was built with IMSDL_MEMSTAT.
+ */
+
+#include "align.h"
+#include "arena.h"
+#include "logger.h"
+#include "memstat.h"
+#include "pool.h"
+#include "profile.h"
+#include "shaders.h"
+#include "viewport.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_FRAMES 500
+#define BENCH_WARMUP 50
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 720
+
+// Fixed seed so every run draws and allocates the same sequence
+#define BENCH_SEED 0x9E3779B97F4A7C15ull
+
+// Rounded rects drawn by the rects workload
+#define BENCH_RECT_COUNT 10000
+
+// Glyph cell used by the panels and list workloads; there is no font yet,
+// so text is drawn as one textured quad per glyph, which is what a font
+// atlas would submit
+#define BENCH_GLYPH_ADVANCE 7.0f
+#define BENCH_GLYPH_WIDTH 6.0f
+#define BENCH_GLYPH_HEIGHT 10.0f
+#define BENCH_LINE_HEIGHT 14.0f
+
+// Rows in the scrolling list and how far it scrolls per frame
+#define BENCH_LIST_ITEMS 10000
+#define BENCH_LIST_ROW_HEIGHT 24.0f
+#define BENCH_LIST_SCROLL 7.0f
+
+// Operations per frame of the allocator workload
+#define BENCH_ARENA_PUSHES 4096
+#define BENCH_POOL_SLOTS 1024
+#define BENCH_ALIGNED_BLOCKS 64
+
+// Messages per frame of the logger workload
+#define BENCH_LOG_MESSAGES 1000
+
+/**
+ * @brief State shared by the workloads.
+ */
+typedef struct BenchContext {
+    IMSDL_Viewport* viewport;
+    float width;
+    float height;
+    Arena* arena; // Allocator workload
+    Pool* pool;
+    void** slots;
+    Logger* logger; // Logger workload
+} BenchContext;
+
+/**
+ * @brief A named, repeatable workload.
+ */
+typedef struct BenchWorkload {
+    const char* name;
+    bool renders; // Each frame is submitted with imsdl_render
+    bool (*setup)(BenchContext* context); // Optional; returns false to skip the workload
+    void (*frame)(BenchContext* context, uint32_t frame);
+    void (*teardown)(BenchContext* context); // Optional
+} BenchWorkload;
+
+/**
+ * @brief Measurements of one workload.
+ */
+typedef struct BenchResult {
+    uint32_t frames;
+    double seconds;
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+    uint64_t draw_calls; // Totals over the measured frames
+    uint64_t vertices;
+    uint64_t indices;
+    uint64_t rects;
+    uint64_t upload_bytes;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+} BenchResult;
+
+/**
+ * @brief Command line options.
+ */
+typedef struct BenchOptions {
+    bool software;
+    uint32_t frames;
+    uint32_t warmup;
+    int width;
+    int height;
+    const char* output;
+} BenchOptions;
+
+// --- Helpers ---
+
+/**
+ * @brief xorshift64*; cheap and identical on every platform.
+ */
+static uint32_t bench_random(uint64_t* state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return (uint32_t) ((*state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+static float bench_random_float(uint64_t* state, float min, float max) {
+    return min + (max - min) * ((float) bench_random(state) / 4294967296.0f);
+}
+
+/**
+ * @brief Stateless hash for content that must not depend on draw order.
+ */
+static uint32_t bench_hash(uint32_t value) {
+    value ^= value >> 16;
+    value *= 0x7FEB352Du;
+    value ^= value >> 15;
+    value *= 0x846CA68Bu;
+    value ^= value >> 16;
+    return value;
+}
+
+/**
+ * @brief Draws length glyph quads starting at (x, y); about one in six is a space.
+ */
+static void bench_draw_text(
+    IMSDL_DrawList* draw, float x, float y, uint32_t seed, uint32_t length, uint32_t color
+) {
+    for (uint32_t i = 0; i < length; i++) {
+        uint32_t glyph = bench_hash(seed + i);
+        if (glyph % 6 != 0) {
+            IMSDL_Vec2 min = {x, y + (float) (glyph % 3)};
+            IMSDL_Vec2 max = {x + BENCH_GLYPH_WIDTH, y + BENCH_GLYPH_HEIGHT};
+            imsdl_draw_image(
+                draw,
+                IMSDL_TEXTURE_NONE,
+                min,
+                max,
+                (IMSDL_Vec2) {0.0f, 0.0f},
+                (IMSDL_Vec2) {1.0f, 1.0f},
+                color
+            );
+        }
+        x += BENCH_GLYPH_ADVANCE;
+    }
+}
+
+static int bench_compare(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Returns the nearest-rank percentile of sorted samples in milliseconds.
+ */
+static double bench_percentile(const uint64_t* sorted, size_t count, size_t percent) {
+    return (double) sorted[(count * percent + 99) / 100 - 1] / 1e6;
+}
+
+/**
+ * @brief Writes a JSON string literal.
+ */
+static void bench_write_string(FILE* out, const char* text) {
+    fputc('"', out);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if ((unsigned char) *c < 0x20) {
+            fprintf(out, "\\u%04x", (unsigned) *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static bool bench_parse_uint(const char* text, uint32_t* value) {
+    char* end = NULL;
+    unsigned long parsed = strtoul(text, &end, 10);
+    if (end == text || *end != '\0' || parsed > UINT32_MAX) {
+        return false;
+    }
+    *value = (uint32_t) parsed;
+    return true;
+}
+
+// --- Workloads ---
+
+/**
+ * @brief Thousands of rounded, partly bordered and translucent rects drifting sideways.
+ */
+static void bench_rects(BenchContext* context, uint32_t frame) {
+    IMSDL_DrawList* draw = context->viewport->draw;
+    float shift = (float) (frame % 64);
+    uint64_t state = BENCH_SEED;
+    for (uint32_t i = 0; i < BENCH_RECT_COUNT; i++) {
+        float x = bench_random_float(&state, -32.0f, context->width);
+        float y = bench_random_float(&state, -32.0f, context->height);
+        float w = bench_random_float(&state, 4.0f, 32.0f);
+        float h = bench_random_float(&state, 4.0f, 32.0f);
+        uint32_t rgb = bench_random(&state) & 0x00FFFFFFu;
+        uint32_t alpha = (i % 4 == 0) ? 160u : 255u;
+        imsdl_draw_rounded_rect(
+            draw,
+            (IMSDL_Vec2) {x + shift, y},
+            (IMSDL_Vec2) {x + shift + w, y + h},
+            (float) (i % 8),
+            rgb | (alpha << 24),
+            (i % 3 == 0) ? 1.5f : 0.0f,
+            IMSDL_RGBA(255, 255, 255, 255)
+        );
+    }
+}
+
+/**
+ * @brief A grid of windows full of text, alternating rects and glyph quads.
+ */
+static void bench_panels(BenchContext* context, uint32_t frame) {
+    IMSDL_DrawList* draw = context->viewport->draw;
+    const float panel_width = 300.0f;
+    const float panel_height = 220.0f;
+    const float gap = 8.0f;
+    uint32_t lines = (uint32_t) ((panel_height - 40.0f) / BENCH_LINE_HEIGHT);
+    uint32_t columns = (uint32_t) ((panel_width - 16.0f) / BENCH_GLYPH_ADVANCE);
+
+    uint32_t panel = 0;
+    for (float y = gap; y + panel_height <= context->height; y += panel_height + gap) {
+        for (float x = gap; x + panel_width <= context->width; x += panel_width + gap) {
+            IMSDL_Vec2 min = {x, y};
+            IMSDL_Vec2 max = {x + panel_width, y + panel_height};
+            imsdl_draw_rounded_rect(
+                draw,
+                min,
+                max,
+                6.0f,
+                IMSDL_RGBA(40, 40, 48, 240),
+                1.0f,
+                IMSDL_RGBA(90, 90, 110, 255)
+            );
+            imsdl_draw_rounded_rect(
+                draw,
+                min,
+                (IMSDL_Vec2) {max.x, y + 24.0f},
+                6.0f,
+                IMSDL_RGBA(60, 90, 160, 255),
+                0.0f,
+                0
+            );
+            bench_draw_text(
+                draw, x + 8.0f, y + 7.0f, panel * 7919u, 20, IMSDL_RGBA(255, 255, 255, 255)
+            );
+
+            // Body text, with one line rewritten every frame like a live value
+            for (uint32_t line = 0; line < lines; line++) {
+                uint32_t seed = panel * 104729u + line * 131u;
+                if (line == 0) {
+                    seed += frame;
+                }
+                uint32_t length = columns / 2 + bench_hash(seed) % (columns / 2);
+                float line_y = y + 32.0f + (float) line * BENCH_LINE_HEIGHT;
+                bench_draw_text(
+                    draw, x + 8.0f, line_y, seed, length, IMSDL_RGBA(220, 220, 220, 255)
+                );
+            }
+            panel++;
+        }
+    }
+}
+
+/**
+ * @brief A long list scrolled a few pixels per frame; only visible rows are drawn.
+ */
+static void bench_list(BenchContext* context, uint32_t frame) {
+    IMSDL_DrawList* draw = context->viewport->draw;
+    float content_height = (float) BENCH_LIST_ITEMS * BENCH_LIST_ROW_HEIGHT;
+    float range = content_height - context->height;
+    float scroll = range > 0.0f ? (float) frame * BENCH_LIST_SCROLL : 0.0f;
+    while (range > 0.0f && scroll > range) {
+        scroll -= range;
+    }
+
+    uint32_t first = (uint32_t) (scroll / BENCH_LIST_ROW_HEIGHT);
+    float y = (float) first * BENCH_LIST_ROW_HEIGHT - scroll;
+    for (uint32_t item = first; item < BENCH_LIST_ITEMS && y < context->height; item++) {
+        float bottom = y + BENCH_LIST_ROW_HEIGHT;
+        uint32_t background
+            = (item % 2) ? IMSDL_RGBA(36, 36, 40, 255) : IMSDL_RGBA(44, 44, 50, 255);
+        imsdl_draw_rect_filled(
+            draw,
+            (IMSDL_Vec2) {0.0f, y},
+            (IMSDL_Vec2) {context->width - 12.0f, bottom},
+            background
+        );
+        imsdl_draw_triangle_filled(
+            draw,
+            (IMSDL_Vec2) {8.0f, y + 6.0f},
+            (IMSDL_Vec2) {8.0f, bottom - 6.0f},
+            (IMSDL_Vec2) {18.0f, y + 12.0f},
+            IMSDL_RGBA(120, 200, 120, 255)
+        );
+        uint32_t length = 12 + bench_hash(item) % 48;
+        uint32_t text = IMSDL_RGBA(230, 230, 230, 255);
+        bench_draw_text(draw, 28.0f, y + 7.0f, item * 31u, length, text);
+        imsdl_draw_line(
+            draw,
+            (IMSDL_Vec2) {0.0f, bottom - 0.5f},
+            (IMSDL_Vec2) {context->width - 12.0f, bottom - 0.5f},
+            IMSDL_RGBA(20, 20, 24, 255),
+            1.0f
+        );
+        y = bottom;
+    }
+
+    // Scrollbar
+    float thumb_height = context->height * context->height / content_height;
+    float thumb_y = range > 0.0f ? scroll / range * (context->height - thumb_height) : 0.0f;
+    imsdl_draw_rounded_rect(
+        draw,
+        (IMSDL_Vec2) {context->width - 10.0f, thumb_y},
+        (IMSDL_Vec2) {context->width - 2.0f, thumb_y + thumb_height},
+        4.0f,
+        IMSDL_RGBA(140, 140, 150, 255),
+        0.0f,
+        0
+    );
+}
+
+static bool bench_allocator_setup(BenchContext* context) {
+    context->arena = arena_create(1024 * 1024, 1, 16);
+    context->pool = pool_create(64, 256, 0);
+    context->slots = (void**) malloc(BENCH_POOL_SLOTS * sizeof(void*));
+    if (!context->arena || !context->pool || !context->slots) {
+        LOG_ERROR("Failed to create allocator workload.");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Mixed-size arena pushes, pool churn in shuffled order, and aligned blocks.
+ */
+static void bench_allocator(BenchContext* context, uint32_t frame) {
+    uint64_t state = BENCH_SEED + frame;
+
+    arena_reset(context->arena);
+    for (uint32_t i = 0; i < BENCH_ARENA_PUSHES; i++) {
+        size_t size = 8 + bench_random(&state) % 249;
+        size_t alignment = (size_t) 8 << (bench_random(&state) % 4);
+        uint8_t* block = (uint8_t*) arena_push(context->arena, size, alignment);
+        if (block) {
+            block[0] = (uint8_t) i;
+        }
+    }
+
+    for (uint32_t i = 0; i < BENCH_POOL_SLOTS; i++) {
+        context->slots[i] = pool_acquire(context->pool);
+    }
+    for (uint32_t i = BENCH_POOL_SLOTS - 1; i > 0; i--) {
+        uint32_t j = bench_random(&state) % (i + 1);
+        void* slot = context->slots[i];
+        context->slots[i] = context->slots[j];
+        context->slots[j] = slot;
+    }
+    for (uint32_t i = 0; i < BENCH_POOL_SLOTS; i++) {
+        pool_release(context->pool, context->slots[i]);
+    }
+
+    for (uint32_t i = 0; i < BENCH_ALIGNED_BLOCKS; i++) {
+        size_t size = 64 + bench_random(&state) % 4033;
+        uint8_t* block = (uint8_t*) aligned_malloc(64, size);
+        if (block) {
+            block[size - 1] = (uint8_t) i;
+        }
+        aligned_free(block);
+    }
+}
+
+static void bench_allocator_teardown(BenchContext* context) {
+    free(context->slots);
+    pool_free(context->pool);
+    arena_free(context->arena);
+    context->slots = NULL;
+    context->pool = NULL;
+    context->arena = NULL;
+}
+
+static bool bench_logger_setup(BenchContext* context) {
+    context->logger = logger_create(LOG_LEVEL_DEBUG, LOG_TYPE_FILE, "/dev/null");
+    if (!context->logger || !logger_start_async(context->logger, 4096, LOG_OVERFLOW_BLOCK)) {
+        LOG_ERROR("Failed to create logger workload.");
+        logger_free(context->logger);
+        context->logger = NULL;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Formatted messages through the async logger, blocking when the ring is full.
+ */
+static void bench_logger(BenchContext* context, uint32_t frame) {
+    for (uint32_t i = 0; i < BENCH_LOG_MESSAGES; i++) {
+        // Error level so IMSDL_LOG_LEVEL can never compile these sites out
+        LOG(
+            context->logger,
+            LOG_LEVEL_ERROR,
+            "frame=%u message=%u x=%d y=%.3f label=%s",
+            frame,
+            i,
+            (int) (i * 7),
+            (double) i * 0.25,
+            "bench"
+        );
+    }
+}
+
+static void bench_logger_teardown(BenchContext* context) {
+    logger_free(context->logger);
+    context->logger = NULL;
+}
+
+static const BenchWorkload bench_workloads[] = {
+    {"rects", true, NULL, bench_rects, NULL},
+    {"panels", true, NULL, bench_panels, NULL},
+    {"list", true, NULL, bench_list, NULL},
+    {"allocator", false, bench_allocator_setup, bench_allocator, bench_allocator_teardown},
+    {"logger", false, bench_logger_setup, bench_logger, bench_logger_teardown},
+};
+
+#define BENCH_WORKLOAD_COUNT (sizeof(bench_workloads) / sizeof(bench_workloads[0]))
+
+// --- Runner ---
+
+/**
+ * @brief Runs warmup and measured frames of a workload.
+ */
+static bool bench_run(
+    BenchContext* context,
+    const BenchWorkload* workload,
+    const BenchOptions* options,
+    GLuint shader_program,
+    GLuint rect_program,
+    BenchResult* result
+) {
+    memset(result, 0, sizeof(BenchResult));
+    uint64_t* samples = (uint64_t*) malloc(options->frames * sizeof(uint64_t));
+    if (!samples) {
+        LOG_ERROR("Failed to allocate memory for %u frame samples.", options->frames);
+        return false;
+    }
+    if (workload->setup && !workload->setup(context)) {
+        free(samples);
+        return false;
+    }
+
+    IMSDL_Viewport* viewport = context->viewport;
+    IMSDL_DrawList* draw = viewport->draw;
+    uint64_t begin = 0;
+    for (uint32_t i = 0; i < options->warmup + options->frames; i++) {
+        bool measured = i >= options->warmup;
+        if (i == options->warmup) {
+            begin = profile_now_ns();
+        }
+
+        uint64_t start = profile_now_ns();
+        workload->frame(context, i);
+        if (measured) {
+            result->draw_calls += draw->command_count;
+            result->vertices += draw->vertex_count;
+            result->indices += draw->index_count;
+            result->rects += draw->rect_count;
+            result->upload_bytes += draw->vertex_count * sizeof(IMSDL_Vertex)
+                                    + draw->index_count * sizeof(IMSDL_Index)
+                                    + draw->rect_count * sizeof(IMSDL_RectInstance);
+        }
+        if (workload->renders) {
+            imsdl_render(viewport, shader_program, rect_program);
+            if (viewport->backend == IMSDL_BACKEND_OPENGL) {
+                glFinish(); // Count the GPU's share of the frame, not just submission
+            }
+        } else {
+            MEMSTAT_FRAME_END();
+        }
+        uint64_t elapsed = profile_now_ns() - start;
+
+        if (measured) {
+            samples[i - options->warmup] = elapsed;
+#ifdef IMSDL_MEMSTAT
+            MemStatInfo total;
+            memstat_query_total(&total);
+            result->allocations += total.last_frame_allocs;
+            result->allocated_bytes += total.last_frame_bytes;
+#endif
+        }
+    }
+
+    result->frames = options->frames;
+    result->seconds = (double) (profile_now_ns() - begin) / 1e9;
+    qsort(samples, options->frames, sizeof(uint64_t), bench_compare);
+    result->p50_ms = bench_percentile(samples, options->frames, 50);
+    result->p99_ms = bench_percentile(samples, options->frames, 99);
+    result->max_ms = (double) samples[options->frames - 1] / 1e6;
+
+    free(samples);
+    if (workload->teardown) {
+        workload->teardown(context);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes one workload's measurements; per-frame values are averages.
+ */
+static void bench_write_result(FILE* out, const char* name, const BenchResult* result) {
+    double frames = (double) result->frames;
+    fprintf(out, "    {\"name\": ");
+    bench_write_string(out, name);
+    fprintf(out, ", \"frames\": %u, \"seconds\": %.6f", result->frames, result->seconds);
+    fprintf(out, ", \"fps\": %.2f", result->seconds > 0.0 ? frames / result->seconds : 0.0);
+    fprintf(
+        out,
+        ", \"frame_ms\": {\"p50\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+        result->p50_ms,
+        result->p99_ms,
+        result->max_ms
+    );
+    fprintf(
+        out,
+        ", \"draw_calls\": %.2f, \"vertices\": %.2f, \"indices\": %.2f, \"rects\": %.2f"
+        ", \"upload_bytes\": %.2f",
+        (double) result->draw_calls / frames,
+        (double) result->vertices / frames,
+        (double) result->indices / frames,
+        (double) result->rects / frames,
+        (double) result->upload_bytes / frames
+    );
+#ifdef IMSDL_MEMSTAT
+    fprintf(
+        out,
+        ", \"allocations\": %.2f, \"allocated_bytes\": %.2f}",
+        (double) result->allocations / frames,
+        (double) result->allocated_bytes / frames
+    );
+#else
+    fprintf(out, ", \"allocations\": null, \"allocated_bytes\": null}");
+#endif
+}
+
+static void bench_usage(const char* program) {
+    fprintf(
+        stderr,
+        "Usage: %s [--software] [--frames N] [--warmup N] [--size WxH] [--output FILE]"
+        " [--list] [workload...]\n",
+        program
+    );
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options = {false, BENCH_FRAMES, BENCH_WARMUP, BENCH_WIDTH, BENCH_HEIGHT, NULL};
+    bool selected[BENCH_WORKLOAD_COUNT] = {false};
+    bool any_selected = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (strcmp(arg, "--software") == 0) {
+            options.software = true;
+        } else if (strcmp(arg, "--frames") == 0 && has_value) {
+            if (!bench_parse_uint(argv[++i], &options.frames) || options.frames == 0) {
+                fprintf(stderr, "Invalid frame count: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--warmup") == 0 && has_value) {
+            if (!bench_parse_uint(argv[++i], &options.warmup)) {
+                fprintf(stderr, "Invalid warmup count: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--size") == 0 && has_value) {
+            if (sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2
+                || options.width <= 0 || options.height <= 0) {
+                fprintf(stderr, "Invalid size: %s\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "--output") == 0 && has_value) {
+            options.output = argv[++i];
+        } else if (strcmp(arg, "--list") == 0) {
+            for (size_t w = 0; w < BENCH_WORKLOAD_COUNT; w++) {
+                printf("%s\n", bench_workloads[w].name);
+            }
+            return 0;
+        } else {
+            size_t w = 0;
+            while (w < BENCH_WORKLOAD_COUNT && strcmp(arg, bench_workloads[w].name) != 0) {
+                w++;
+            }
+            if (w == BENCH_WORKLOAD_COUNT) {
+                bench_usage(argv[0]);
+                return 1;
+            }
+            selected[w] = true;
+            any_selected = true;
+        }
+    }
+
+    // Keep the report on stdout clean; only errors reach stderr
+    logger_set_level(&global_logger, LOG_LEVEL_ERROR);
+
+    IMSDL_Viewport* viewport = NULL;
+    if (options.software) {
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+        viewport = imsdl_create_software_viewport(
+            "imsdl_bench", options.width, options.height, SDL_WINDOW_HIDDEN
+        );
+    } else {
+        viewport = imsdl_create_headless_viewport("imsdl_bench", options.width, options.height);
+    }
+    if (!viewport) {
+        LOG_ERROR("Failed to create benchmark viewport.");
+        return 1;
+    }
+
+    GLuint shader_program = 0;
+    GLuint rect_program = 0;
+    const char* renderer = viewport->raster ? viewport->raster->kernel : "unknown";
+    if (!options.software) {
+        shader_program = imsdl_create_shader_program("vertex.glsl", "fragment.glsl");
+        rect_program = imsdl_create_shader_program("rect_vertex.glsl", "rect_fragment.glsl");
+        const GLubyte* name = glGetString(GL_RENDERER);
+        renderer = name ? (const char*) name : "unknown";
+    }
+
+    FILE* out = stdout;
+    if (options.output) {
+        out = fopen(options.output, "w");
+        if (!out) {
+            LOG_ERROR("Failed to open benchmark report: %s", options.output);
+            imsdl_destroy_viewport(viewport);
+            return 1;
+        }
+    }
+
+    const char* backend = options.software ? "software" : "opengl";
+    fprintf(out, "{\n  \"backend\": \"%s\",\n  \"renderer\": ", backend);
+    bench_write_string(out, renderer);
+    fprintf(
+        out,
+        ",\n  \"width\": %d,\n  \"height\": %d,\n  \"warmup\": %u,\n  \"workloads\": [\n",
+        options.width,
+        options.height,
+        options.warmup
+    );
+
+    BenchContext context = {0};
+    context.viewport = viewport;
+    context.width = (float) options.width;
+    context.height = (float) options.height;
+
+    bool ok = true;
+    bool first = true;
+    for (size_t w = 0; w < BENCH_WORKLOAD_COUNT; w++) {
+        if (any_selected && !selected[w]) {
+            continue;
+        }
+        BenchResult result;
+        const BenchWorkload* workload = &bench_workloads[w];
+        if (!bench_run(&context, workload, &options, shader_program, rect_program, &result)) {
+            LOG_ERROR("Workload %s failed.", workload->name);
+            ok = false;
+            continue;
+        }
+        fprintf(out, first ? "" : ",\n");
+        bench_write_result(out, workload->name, &result);
+        first = false;
+    }
+    fprintf(out, "\n  ]\n}\n");
+
+    if (out != stdout && fclose(out) != 0) {
+        LOG_ERROR("Failed to write benchmark report: %s", options.output);
+        ok = false;
+    }
+
+    if (!options.software) {
+        glDeleteProgram(shader_program);
+        glDeleteProgram(rect_program);
+    }
+    imsdl_destroy_viewport(viewport);
+    return ok ? 0 : 1;
+}
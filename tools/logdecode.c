@@ -0,0 +1,341 @@
+/**
+ * @file tools/logdecode.c
+ * @brief Converts a binary log written with LOG_TYPE_BINARY back into text.
+ *
+ * Usage: imsdl_logdecode <binary log> [output file]
+ *
+ * Each message is replayed through printf with the original format string
+ * and the recorded argument values, prefixed with its timestamp and level.
+ * The log must be decoded on a machine with the same endianness as the one
+ * that wrote it.
+ */
+
+#include "logger.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief A format string definition, keyed by its address in the writer.
+ */
+typedef struct LogDecodeFormat {
+    uint64_t id;
+    char* text;
+} LogDecodeFormat;
+
+/**
+ * @brief Open addressing table of format definitions.
+ */
+typedef struct LogDecodeTable {
+    LogDecodeFormat* entries;
+    size_t capacity;
+    size_t count;
+} LogDecodeTable;
+
+static LogDecodeFormat* log_decode_find(LogDecodeTable* table, uint64_t id) {
+    size_t index = (size_t) (id >> 3) & (table->capacity - 1);
+    while (table->entries[index].text && table->entries[index].id != id) {
+        index = (index + 1) & (table->capacity - 1);
+    }
+    return &table->entries[index];
+}
+
+static bool log_decode_define(
+    LogDecodeTable* table, uint64_t id, const uint8_t* text, size_t size
+) {
+    // Keep the table at most half full
+    if ((table->count + 1) * 2 > table->capacity) {
+        LogDecodeTable grown = {NULL, table->capacity * 2, 0};
+        grown.entries = (LogDecodeFormat*) calloc(grown.capacity, sizeof(LogDecodeFormat));
+        if (NULL == grown.entries) {
+            return false;
+        }
+        for (size_t i = 0; i < table->capacity; i++) {
+            if (table->entries[i].text) {
+                *log_decode_find(&grown, table->entries[i].id) = table->entries[i];
+                grown.count++;
+            }
+        }
+        free(table->entries);
+        *table = grown;
+    }
+
+    LogDecodeFormat* entry = log_decode_find(table, id);
+    if (NULL == entry->text) {
+        table->count++;
+    }
+    free(entry->text); // A later definition replaces an earlier one at the same address
+    entry->id = id;
+    entry->text = (char*) malloc(size + 1);
+    if (NULL == entry->text) {
+        return false;
+    }
+    memcpy(entry->text, text, size);
+    entry->text[size] = '\0';
+    return true;
+}
+
+/**
+ * @brief Cursor over a record payload.
+ */
+typedef struct LogDecodeReader {
+    const uint8_t* data;
+    size_t length;
+    size_t offset;
+} LogDecodeReader;
+
+static bool log_decode_read(LogDecodeReader* reader, void* out, size_t size) {
+    if (size > reader->length - reader->offset) {
+        return false;
+    }
+    memcpy(out, reader->data + reader->offset, size);
+    reader->offset += size;
+    return true;
+}
+
+static int64_t log_decode_int(LogDecodeReader* reader) {
+    uint64_t value = 0;
+    log_decode_read(reader, &value, sizeof(value));
+    return (int64_t) value;
+}
+
+/**
+ * @brief Prints one conversion with its recorded argument.
+ */
+static void log_decode_spec(FILE* out, const LogFormatSpec* spec, LogDecodeReader* reader) {
+    int64_t width = spec->width == LOG_ARG_INT ? log_decode_int(reader) : 0;
+    int64_t precision = spec->precision == LOG_ARG_INT ? log_decode_int(reader) : 0;
+
+    // Rebuild the conversion with '*' replaced by the recorded values
+    char conversion[128];
+    size_t length = 0;
+    bool seen_width = false;
+    for (size_t i = 0; i < spec->length && length < sizeof(conversion) - 24; i++) {
+        char c = spec->start[i];
+        if (c == '*' && !seen_width && spec->width == LOG_ARG_INT && spec->start[i - 1] != '.') {
+            length += (size_t) snprintf(conversion + length, 24, "%lld", (long long) width);
+            seen_width = true;
+        } else if (c == '*') {
+            if (precision >= 0) {
+                length += (size_t) snprintf(conversion + length, 24, "%lld", (long long) precision);
+            } else {
+                length--; // A negative precision is treated as omitted; drop the '.'
+            }
+        } else {
+            conversion[length++] = c;
+        }
+    }
+    conversion[length] = '\0';
+
+    uint64_t value = 0;
+    switch (spec->value) {
+        case LOG_ARG_NONE:
+            if (conversion[length - 1] == '%') {
+                fputc('%', out);
+            }
+            return;
+        case LOG_ARG_LDOUBLE: {
+            uint8_t bytes[16];
+            long double number = 0;
+            if (log_decode_read(reader, bytes, sizeof(bytes))) {
+                size_t size = sizeof(number) < sizeof(bytes) ? sizeof(number) : sizeof(bytes);
+                memcpy(&number, bytes, size);
+            }
+            fprintf(out, conversion, number);
+            return;
+        }
+        case LOG_ARG_STRING: {
+            uint32_t size = 0;
+            log_decode_read(reader, &size, sizeof(size));
+            if (size == UINT32_MAX) {
+                fprintf(out, conversion, (const char*) NULL);
+                return;
+            }
+            char* string = (char*) malloc((size_t) size + 1);
+            if (string && log_decode_read(reader, string, size)) {
+                string[size] = '\0';
+                fprintf(out, conversion, string);
+            }
+            free(string);
+            return;
+        }
+        default:
+            log_decode_read(reader, &value, sizeof(value));
+            break;
+    }
+
+    // %n has nothing to print
+    if (conversion[length - 1] == 'n') {
+        return;
+    }
+
+    switch (spec->value) {
+        case LOG_ARG_INT:
+            fprintf(out, conversion, (int) value);
+            break;
+        case LOG_ARG_LONG:
+            fprintf(out, conversion, (long) value);
+            break;
+        case LOG_ARG_LLONG:
+            fprintf(out, conversion, (long long) value);
+            break;
+        case LOG_ARG_SIZE:
+            fprintf(out, conversion, (size_t) value);
+            break;
+        case LOG_ARG_INTMAX:
+            fprintf(out, conversion, (intmax_t) value);
+            break;
+        case LOG_ARG_PTRDIFF:
+            fprintf(out, conversion, (ptrdiff_t) value);
+            break;
+        case LOG_ARG_DOUBLE: {
+            double number;
+            memcpy(&number, &value, sizeof(number));
+            fprintf(out, conversion, number);
+            break;
+        }
+        case LOG_ARG_POINTER:
+            fprintf(out, conversion, (void*) (uintptr_t) value);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Prints a message record as a line of text.
+ */
+static void log_decode_message(
+    FILE* out,
+    const char* format,
+    uint8_t level,
+    int32_t error,
+    uint64_t timestamp,
+    LogDecodeReader* reader
+) {
+    static const char* LEVEL_NAME[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+    const char* name = level < 4 ? LEVEL_NAME[level] : "UNKNOWN";
+
+    fprintf(
+        out,
+        "[%llu.%09llu] ",
+        (unsigned long long) (timestamp / 1000000000ull),
+        (unsigned long long) (timestamp % 1000000000ull)
+    );
+    if (level >= LOG_LEVEL_WARN && error != 0) {
+        fprintf(out, "[%s:%s] ", name, strerror(error));
+    } else {
+        fprintf(out, "[%s] ", name);
+    }
+
+    // Literal text between conversions is copied through unchanged
+    LogFormatSpec spec;
+    const char* text = format;
+    for (const char* p = log_format_next(text, &spec); p; p = log_format_next(text, &spec)) {
+        fwrite(text, 1, (size_t) (spec.start - text), out);
+        log_decode_spec(out, &spec, reader);
+        text = p;
+    }
+    fputs(text, out);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <binary log> [output file]\n", argv[0]);
+        return 1;
+    }
+
+    FILE* in = fopen(argv[1], "rb");
+    if (NULL == in) {
+        fprintf(stderr, "Failed to open %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+    FILE* out = argc > 2 ? fopen(argv[2], "w") : stdout;
+    if (NULL == out) {
+        fprintf(stderr, "Failed to open %s: %s\n", argv[2], strerror(errno));
+        fclose(in);
+        return 1;
+    }
+
+    // Read the whole log into memory
+    fseek(in, 0, SEEK_END);
+    long file_size = ftell(in);
+    rewind(in);
+    uint8_t* data = file_size > 0 ? (uint8_t*) malloc((size_t) file_size) : NULL;
+    if (NULL == data || fread(data, 1, (size_t) file_size, in) != (size_t) file_size) {
+        fprintf(stderr, "Failed to read %s\n", argv[1]);
+        free(data);
+        fclose(in);
+        return 1;
+    }
+    fclose(in);
+
+    LogDecodeReader file = {data, (size_t) file_size, 0};
+    char magic[8];
+    uint32_t version = 0;
+    if (!log_decode_read(&file, magic, sizeof(magic)) || memcmp(magic, LOG_BINARY_MAGIC, 8) != 0
+        || !log_decode_read(&file, &version, sizeof(version)) || version != LOG_BINARY_VERSION) {
+        fprintf(stderr, "%s is not a version %d binary log\n", argv[1], LOG_BINARY_VERSION);
+        free(data);
+        return 1;
+    }
+
+    LogDecodeTable formats = {NULL, 256, 0};
+    formats.entries = (LogDecodeFormat*) calloc(formats.capacity, sizeof(LogDecodeFormat));
+
+    int status = 0;
+    uint8_t tag;
+    while (formats.entries && log_decode_read(&file, &tag, sizeof(tag))) {
+        uint64_t id = 0;
+        if (tag == 'F') {
+            uint32_t size = 0;
+            if (!log_decode_read(&file, &id, sizeof(id))
+                || !log_decode_read(&file, &size, sizeof(size)) || size > file.length - file.offset
+                || !log_decode_define(&formats, id, file.data + file.offset, size)) {
+                status = 1;
+                break;
+            }
+            file.offset += size;
+        } else if (tag == 'M') {
+            uint8_t level = 0;
+            int32_t error = 0;
+            uint64_t timestamp = 0;
+            uint32_t payload = 0;
+            if (!log_decode_read(&file, &level, sizeof(level))
+                || !log_decode_read(&file, &error, sizeof(error))
+                || !log_decode_read(&file, &id, sizeof(id))
+                || !log_decode_read(&file, &timestamp, sizeof(timestamp))
+                || !log_decode_read(&file, &payload, sizeof(payload))
+                || payload > file.length - file.offset) {
+                status = 1;
+                break;
+            }
+
+            LogDecodeReader reader = {file.data + file.offset, payload, 0};
+            const LogDecodeFormat* format = log_decode_find(&formats, id);
+            if (format->text) {
+                log_decode_message(out, format->text, level, error, timestamp, &reader);
+            } else {
+                fprintf(out, "<undefined format %#llx>\n", (unsigned long long) id);
+            }
+            file.offset += payload;
+        } else {
+            status = 1;
+            break;
+        }
+    }
+
+    if (status != 0) {
+        fprintf(stderr, "Truncated or corrupt record at offset %zu\n", file.offset);
+    }
+
+    for (size_t i = 0; formats.entries && i < formats.capacity; i++) {
+        free(formats.entries[i].text);
+    }
+    free(formats.entries);
+    free(data);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return status;
+}